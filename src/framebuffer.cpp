@@ -0,0 +1,134 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "framebuffer.h"
+#include <stdlib.h>
+#include <stdexcept>
+
+FrameBuffer::FrameBuffer(size_t capacity) {
+	this->capacity = capacity;
+	this->begin = 0;
+	this->scanned = 0;
+	this->end = 0;
+	this->buffer = (char*)malloc(this->capacity);
+	if (!this->buffer) {
+		throw bad_alloc();
+	}
+}
+
+FrameBuffer::~FrameBuffer() {
+	if (this->buffer) {
+		free(this->buffer);
+		this->buffer = NULL;
+	}
+}
+
+char *FrameBuffer::prepareWrite(size_t &space, size_t minFree) {
+	minFree += FRAME_BUFFER_PADDING;
+
+	if (this->capacity - this->end < minFree) {
+		// reclaim the space of the messages already handed out
+		if (this->begin > 0) {
+			memmove(this->buffer, this->buffer + this->begin, this->end - this->begin);
+			this->end -= this->begin;
+			this->begin = 0;
+		}
+
+		// a single message is bigger than the buffer
+		if (this->capacity - this->end < minFree) {
+			size_t capacity = this->capacity * 2;
+			while (capacity - this->end < minFree) {
+				capacity *= 2;
+			}
+			char *buffer = (char*)realloc(this->buffer, capacity);
+			if (!buffer) {
+				throw bad_alloc();
+			}
+			this->buffer = buffer;
+			this->capacity = capacity;
+		}
+	}
+
+	space = this->capacity - this->end - FRAME_BUFFER_PADDING;
+	return this->buffer + this->end;
+}
+
+void FrameBuffer::commitWrite(size_t bytes) {
+	this->end += bytes;
+}
+
+bool FrameBuffer::nextFrame(string_view &frame) {
+
+	size_t start = this->begin + this->scanned;
+	char *terminator = (char*)memchr(this->buffer + start, '\0', this->end - start);
+	if (!terminator) {
+		// message not complete, wait for more data
+		this->scanned = this->end - this->begin;
+		return false;
+	}
+
+	size_t len = terminator - (this->buffer + this->begin);
+	frame = string_view(this->buffer + this->begin, len);
+
+	this->begin += len + 1;
+	this->scanned = 0;
+
+	if (this->begin == this->end) {
+		this->begin = 0;
+		this->end = 0;
+	}
+	return true;
+}
+
+bool FrameBuffer::nextBatch(string_view &batch) {
+	string_view frame;
+	if (!this->nextFrame(frame)) {
+		return false;
+	}
+	// the frames stay where they are until the next prepareWrite()
+	const char *first = frame.data();
+	size_t length = frame.length() + 1;
+	while (this->nextFrame(frame)) {
+		length = frame.data() + frame.length() + 1 - first;
+	}
+	batch = string_view(first, length);
+	return true;
+}
+
+bool FrameBuffer::splitBatch(string_view &batch, string_view &frame) {
+	if (batch.empty()) {
+		return false;
+	}
+	const char *terminator = (const char*)memchr(batch.data(), '\0', batch.length());
+	size_t len = terminator ? terminator - batch.data() : batch.length();
+	frame = batch.substr(0, len);
+	batch.remove_prefix(terminator ? len + 1 : len);
+	return true;
+}
+
+size_t FrameBuffer::pending() {
+	return this->end - this->begin;
+}
+
+void FrameBuffer::clear() {
+	this->begin = 0;
+	this->scanned = 0;
+	this->end = 0;
+}
@@ -0,0 +1,64 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _FRAMEBUFFER_
+#define _FRAMEBUFFER_
+
+#include <string.h>
+#include <string_view>
+
+using namespace std;
+
+#define FRAME_BUFFER_SIZE		65536	// initial capacity, grows if a single message gets bigger
+#define FRAME_BUFFER_READ_SIZE	16384	// minimum free space requested for one read()
+#define FRAME_BUFFER_PADDING	64		// readable bytes kept behind the received data (at least SIMDJSON_PADDING)
+
+// Receive buffer for the NUL-terminated messages of the UA protocol.
+// The socket reads directly into the buffer and complete messages are handed out
+// as string_view pointing into the buffer, so nothing gets copied.
+// Consumed bytes are reclaimed by moving the (incomplete) rest to the front,
+// which keeps every message contiguous in memory.
+// A handed out message stays valid until the next call of prepareWrite().
+// prepareWrite() never hands out the last FRAME_BUFFER_PADDING bytes, so the JSON
+// parser may read that far behind any message and parse it in place.
+// nextBatch() hands out all complete messages at once, each with its terminating NUL;
+// splitBatch() takes them apart again.
+class FrameBuffer
+{
+private:
+	char *buffer;
+	size_t capacity;
+	size_t begin;	// first byte not yet handed out
+	size_t scanned;	// bytes after begin already searched for a terminator
+	size_t end;		// end of received data
+public:
+	FrameBuffer(size_t capacity = FRAME_BUFFER_SIZE); // throws exception
+	~FrameBuffer();
+	char *prepareWrite(size_t &space, size_t minFree = FRAME_BUFFER_READ_SIZE);
+	void commitWrite(size_t bytes);
+	bool nextFrame(string_view &frame);
+	bool nextBatch(string_view &batch);
+	static bool splitBatch(string_view &batch, string_view &frame);
+	size_t pending();
+	void clear();
+};
+
+#endif
@@ -29,7 +29,7 @@ mutex g_mutex_serverList;
 mutex g_mutex_uaDevices;
 
 int g_userEventBeginNum = 0;
-#define USER_EVENT_COUNT				15
+#define USER_EVENT_COUNT				19
 #define EVENT_CONNECT					1
 #define EVENT_DISCONNECT				2
 #define EVENT_DEVICES_INITIATE_RELOAD	3
@@ -46,14 +46,28 @@ int g_userEventBeginNum = 0;
 #define EVENT_DEVICE_ONLINE				14
 #define EVENT_UPDATE_CONNECT_BUTTONS	15
 #define EVENT_BROWSE_TO_CHANNEL			16
+#define EVENT_CONNECTION_STATE			17
+#define EVENT_CONNECT_DONE				18
+#define EVENT_STANDBY_UPDATE			19
 
 GFXEngine *gfx = NULL;
 
 SDL_Window *g_window;
 SDL_TimerID g_timer_network_serverlist;
 SDL_TimerID g_timer_network_reconnect;
-SDL_TimerID g_timer_network_timeout;
-SDL_TimerID g_timer_network_send_timeout_msg;
+SDL_TimerID g_timer_network_watchdog;
+SDL_TimerID g_timer_standby;
+atomic<int64_t> g_networkLastFrame; // ms, steady clock; the only thing the receive path touches
+atomic<int64_t> g_networkLastProbe;
+atomic<int64_t> g_networkProbePending; // send time of the unanswered probe, 0 if none
+atomic<int> g_networkRto; // ms, retransmission timeout like TCP derived from the probe round trips
+mutex g_mutex_networkRtt; // the receive path adds the probe samples, the main thread resets and logs
+int64_t g_networkSrtt; // us
+int64_t g_networkRttvar; // us
+int64_t g_networkRttMin; // us, probe round trip statistics of the connection for comparing socket profiles
+int64_t g_networkRttMax; // us
+int64_t g_networkRttSum; // us
+int64_t g_networkRttSamples;
 SDL_TimerID g_timerFlipPage;
 SDL_TimerID g_timerResetOrder;
 SDL_TimerID g_timerUnmuteAll;
@@ -65,6 +79,7 @@ int g_unmuteAllCountdown;
 int g_selectAllChannelsCountdown;
 
 Settings g_settings;
+ServerCache g_serverCache;
 map<string, string> serverSettingsJSON;
 
 string g_msg;
@@ -72,6 +87,11 @@ string g_msg;
 vector<string> g_ua_serverList;
 string g_ua_server_connected;
 int g_ua_server_last_connection;
+string g_ua_server_connecting;
+string g_ua_server_model; // server the kept device and channel model belongs to
+bool g_resyncModel; // reconnect reconciles the kept model instead of loading a new one
+atomic<int> g_connectionState;
+atomic<int> g_connectGeneration;
 
 string g_selectedMixBus;
 
@@ -146,6 +166,24 @@ Button* g_btnSimulation;
 vector<Button*> g_btnsServers;
 
 TCPClient *g_tcpClient;
+TrafficRecorder g_recorder;
+bool g_recording; // set once on start, keeps the receive path free of the recorder lock otherwise
+string g_replayFile;
+double g_replaySpeed;
+atomic<bool> g_replayStop; // the replay thread ends at the next frame
+TCPSendStats g_sendStatsLogged;
+MeterQueue g_meterQueue;
+PathRouter<UARouteHandler> g_routes; // built once by initRoutes()
+vector<MeterFrame> g_meterValues; // main loop only
+MPSCQueue<ModelUpdate> g_modelUpdates(MODEL_QUEUE_SIZE); // filled by the receiving threads, drained by the main loop
+mutex g_mutex_modelOverflow;
+vector<ModelUpdate> g_modelOverflow; // control values are never dropped, they wait here while the queue is full
+atomic<bool> g_modelOverflowing; // g_modelOverflow is in use, newer values go there too to keep the order
+atomic<size_t> g_framesInvalidJson; // malformed frames, counted instead of logged one by one
+atomic<size_t> g_framesWithoutPath;
+atomic<size_t> g_framesInvalidData; // data of another type than the path needs
+size_t g_framesMalformedLogged;
+size_t g_meterDroppedLogged;
 int g_page;
 
 GFXFont *g_fntMain;
@@ -182,8 +220,11 @@ GFXSurface* g_gsLabelOrange[4];
 GFXSurface* g_gsLabelPurple[4];
 
 bool g_refreshingServerList;
+atomic<unsigned int> g_serverScanProbed;
+atomic<unsigned int> g_serverScanTotal;
 vector<UADevice*> g_ua_devices;
 unordered_map<string, Channel*> g_channelsById;
+vector<array<vector<Channel*>, UA_CHANNEL_TYPES>> g_channelTable; // g_channelsById indexed by [device][type][channel]
 map<int, Channel*> g_channelsInOrder;
 set<Channel*> g_touchpointChannels;
 set<string> g_channelsMutedBeforeAllMute;
@@ -210,40 +251,99 @@ void writeLog(int type, const string &s) {
 	}
 }
 
-string json_workaround_secure_unicode_characters(string &input)
+// doubles the backslash of every \u escape, so the log shows the escape itself
+string json_workaround_secure_unicode_characters(string_view input)
 {
-	size_t sz = 0;
-	do
-	{
-		sz = input.find("\\u", sz);
-		if (sz == string::npos)
-			return input;
-
-		input.replace(sz, 2,  "\\\\u");
-		sz += 3;
-	} while (true);
+	string output;
+	output.reserve(input.length() + 16);
+	for (size_t n = 0; n < input.length(); n++) {
+		if (input[n] == '\\' && n + 1 < input.length() && input[n + 1] == 'u') {
+			output += '\\';
+		}
+		output += input[n];
+	}
+	return output;
+}
 
-	return input;
+static int hex_to_int(string_view input, size_t pos) { // 4 hex digits or -1
+	if (pos + 4 > input.length()) {
+		return -1;
+	}
+	int value = 0;
+	for (size_t n = pos; n < pos + 4; n++) {
+		char c = input[n];
+		value <<= 4;
+		if (c >= '0' && c <= '9') {
+			value |= c - '0';
+		}
+		else if (c >= 'a' && c <= 'f') {
+			value |= c - 'a' + 10;
+		}
+		else if (c >= 'A' && c <= 'F') {
+			value |= c - 'A' + 10;
+		}
+		else {
+			return -1;
+		}
+	}
+	return value;
 }
 
-inline string unescape_to_utf8(string &input)
+// decodes the \uXXXX escapes UA sends in names (UTF-16, surrogate pairs included) to UTF-8
+// in one pass; the output is never longer than the input, so it is written directly into it
+void unescape_to_utf8(string_view input, string &output)
 {
-	size_t sz = 0;
-	do
-	{
-		sz = input.find("\\u", sz);
-		if (sz == string::npos)
-			return input;
-
-		string num = input.substr(sz+2, 4);
-
-		char c = (char)strtol(num.c_str(), NULL, 16);
+	output.resize(input.length());
+	char *out = &output[0];
+	size_t n = 0;
+	while (n < input.length()) {
+		int unit;
+		if (input[n] != '\\' || n + 1 >= input.length() || input[n + 1] != 'u'
+			|| (unit = hex_to_int(input, n + 2)) < 0) {
+			*out++ = input[n++];
+			continue;
+		}
+		n += 6;
 
-		input.replace(sz, 6, 1, c);
-		sz++;
-	} while (true);
+		uint32_t cp = (uint32_t)unit;
+		if (cp >= 0xD800 && cp <= 0xDBFF) {
+			int low;
+			if (n + 1 < input.length() && input[n] == '\\' && input[n + 1] == 'u'
+				&& (low = hex_to_int(input, n + 2)) >= 0xDC00 && low <= 0xDFFF) {
+				cp = 0x10000 + ((cp - 0xD800) << 10) + ((uint32_t)low - 0xDC00);
+				n += 6;
+			}
+			else {
+				cp = 0xFFFD; // high surrogate without low one
+			}
+		}
+		else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+			cp = 0xFFFD; // low surrogate without high one
+		}
 
-	return input;
+		if (cp == 0) { // would cut the name
+			continue;
+		}
+		if (cp < 0x80) {
+			*out++ = (char)cp;
+		}
+		else if (cp < 0x800) {
+			*out++ = (char)(0xC0 | (cp >> 6));
+			*out++ = (char)(0x80 | (cp & 0x3F));
+		}
+		else if (cp < 0x10000) {
+			*out++ = (char)(0xE0 | (cp >> 12));
+			*out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+			*out++ = (char)(0x80 | (cp & 0x3F));
+		}
+		else {
+			*out++ = (char)(0xF0 | (cp >> 18));
+			*out++ = (char)(0x80 | ((cp >> 12) & 0x3F));
+			*out++ = (char)(0x80 | ((cp >> 6) & 0x3F));
+			*out++ = (char)(0x80 | (cp & 0x3F));
+		}
+	}
+	output.resize(out - output.data());
 }
 
 void pushEvent(int eventId, void* data1=NULL, void* data2=NULL) {
@@ -1007,6 +1107,7 @@ Channel::~Channel() {
 		SAFE_DELETE(it->second);
 	}
 	this->sendsById.clear();
+	this->sendSlots.clear();
 	this->sendsByName.clear();
 }
 
@@ -1473,12 +1574,14 @@ UADevice::UADevice(const string &us_deviceId) {
 	this->online = false;
 	this->id = us_deviceId;
 	this->channelsTotal = 0;
+}
+UADevice::~UADevice() {
+}
 
+void UADevice::init() {
 	string msg = "subscribe /devices/" + this->id + "/DeviceOnline/";
 	tcpClientSend(msg);
 }
-UADevice::~UADevice() {
-}
 
 int getActiveChannelsCount(bool onlyVisible)
 {
@@ -1515,10 +1618,126 @@ void clearChannels() {
 		SAFE_DELETE(it->second);
 	}
 	g_channelsById.clear();
+	g_channelTable.clear();
 	g_channelsInOrder.clear();
 	g_touchpointChannels.clear();
 }
 
+bool getUAIndex(const string &id, unsigned &index) {
+	if (id.empty() || id.length() > 4) {
+		return false;
+	}
+	index = 0;
+	for (size_t n = 0; n < id.length(); n++) {
+		if (id[n] < '0' || id[n] > '9') {
+			return false;
+		}
+		index = index * 10 + (unsigned)(id[n] - '0');
+	}
+	return index < UA_MAX_INDEX;
+}
+
+void setChannelTableEntry(Channel *channel, Channel *entry) {
+	unsigned device, index;
+	if (!getUAIndex(channel->device->id, device) || !getUAIndex(channel->id, index)) {
+		return;
+	}
+	if (device >= g_channelTable.size()) {
+		if (!entry) {
+			return;
+		}
+		g_channelTable.resize(device + 1);
+	}
+	vector<Channel*> &channels = g_channelTable[device][channel->type];
+	if (index >= channels.size()) {
+		if (!entry) {
+			return;
+		}
+		channels.resize(index + 1, NULL);
+	}
+	channels[index] = entry;
+}
+
+string getChannelKey(const string &ua_device_id, const string &ua_channel_id, int type) {
+	string type_str;
+	if (type == INPUT) {
+		type_str = ".input.";
+	}
+	else if (type == AUX) {
+		type_str = ".aux.";
+	}
+	else if (type == MASTER) {
+		type_str = ".master.";
+	}
+	return ua_device_id + type_str + ua_channel_id;
+}
+
+void addChannel(Channel *channel) {
+	g_channelsById.insert({ getChannelKey(channel->device->id, channel->id, channel->type), channel });
+	setChannelTableEntry(channel, channel);
+}
+
+void removeChannel(Channel *channel) {
+	for (unordered_map<string, Channel*>::iterator it = g_channelsById.begin(); it != g_channelsById.end(); ++it) {
+		if (it->second == channel) {
+			g_channelsById.erase(it);
+			break;
+		}
+	}
+	setChannelTableEntry(channel, NULL);
+	for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
+		if (it->second == channel) {
+			g_channelsInOrder.erase(it);
+			break;
+		}
+	}
+	g_touchpointChannels.erase(channel);
+
+	if (channel->type == INPUT) {
+		channel->device->channelsTotal--;
+	}
+	SAFE_DELETE(channel);
+
+	g_activeChannelsCount = -1;
+	g_visibleChannelsCount = -1;
+}
+
+// removes the channels of a device that are missing in a fresh children listing
+void removeVanishedChannels(UADevice *dev, int type, const vector<string> &ids) {
+	vector<Channel*> vanished;
+	for (unordered_map<string, Channel*>::iterator it = g_channelsById.begin(); it != g_channelsById.end(); ++it) {
+		if (it->second->device == dev && it->second->type == type && find(ids.begin(), ids.end(), it->second->id) == ids.end()) {
+			vanished.push_back(it->second);
+		}
+	}
+	for (vector<Channel*>::iterator it = vanished.begin(); it != vanished.end(); ++it) {
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Channel " + (*it)->id + " of device " + dev->id + " vanished");
+		removeChannel(*it);
+	}
+}
+
+// the server forgets all subscriptions with the connection, the kept model has to subscribe again
+void resetSubscriptions() {
+	for (unordered_map<string, Channel*>::iterator it = g_channelsById.begin(); it != g_channelsById.end(); ++it) {
+		Channel *channel = it->second;
+		channel->subscriptions = 0;
+		channel->meter_level = fromDbFS(-144.0);
+		channel->meter_level2 = fromDbFS(-144.0);
+		for (unordered_map<string, Send*>::iterator itS = channel->sendsById.begin(); itS != channel->sendsById.end(); ++itS) {
+			itS->second->subscriptions = 0;
+			itS->second->meter_level = fromDbFS(-144.0);
+			itS->second->meter_level2 = fromDbFS(-144.0);
+		}
+	}
+}
+
+int getFreeChannelOrder(int order) {
+	while (g_channelsInOrder.find(order) != g_channelsInOrder.end()) {
+		order++;
+	}
+	return order;
+}
+
 void updateSubscriptions() {
 
 	if (!isLoading()) {
@@ -1573,32 +1792,32 @@ Send *Channel::getSendByName(const string &name)
 	return NULL;
 }
 
-Send* Channel::getSendByUAId(const string &id)
+void Channel::addSend(const string &name, Send *send)
 {
-	unordered_map<string, Send*>::iterator res = this->sendsById.find(id);
+	this->sendsByName.insert({ name, send });
+	this->sendsById.insert({ send->id, send });
 
-	if (res != this->sendsById.end()) {
-		return res->second;
+	unsigned index;
+	if (getUAIndex(send->id, index)) {
+		if (index >= this->sendSlots.size()) {
+			this->sendSlots.resize(index + 1, NULL);
+		}
+		this->sendSlots[index] = send;
 	}
+}
 
+Send* Channel::getSendByUAIndex(unsigned index)
+{
+	if (index < this->sendSlots.size()) {
+		return this->sendSlots[index];
+	}
 	return NULL;
 }
 
-Channel *getChannelByUAIds(string ua_device_id, string ua_channel_id, int type)
+Channel *getChannelByUAIds(const string &ua_device_id, const string &ua_channel_id, int type)
 {
-	string type_str;
-	if (type == INPUT) {
-		type_str = ".input.";
-	}
-	else if (type == AUX) {
-		type_str = ".aux.";
-	}
-	else if (type == MASTER) {
-		type_str = ".master.";
-	}
+	unordered_map<string, Channel*>::iterator res = g_channelsById.find(getChannelKey(ua_device_id, ua_channel_id, type));
 
-	unordered_map<string, Channel*>::iterator res = g_channelsById.find(ua_device_id + type_str + ua_channel_id);
-	
 	if (res != g_channelsById.end()) {
 		return res->second;
 	}
@@ -1606,6 +1825,19 @@ Channel *getChannelByUAIds(string ua_device_id, string ua_channel_id, int type)
 	return NULL;
 }
 
+// hot path of the received values, the ids are taken from the path as numbers
+Channel *getChannelByUAIndex(unsigned device, unsigned index, int type)
+{
+	if (device >= g_channelTable.size() || type < 0 || type >= UA_CHANNEL_TYPES) {
+		return NULL;
+	}
+	const vector<Channel*> &channels = g_channelTable[device][type];
+	if (index < channels.size()) {
+		return channels[index];
+	}
+	return NULL;
+}
+
 Channel* getChannelByTouchpointId(bool _is_mouse, SDL_TouchFingerEvent *touch_input)
 {
 	if (!touch_input && !_is_mouse)
@@ -1687,6 +1919,11 @@ bool serverListAdd(const string& server) {
 	return false;
 }
 
+vector<string> serverListGetAll() {
+	const std::lock_guard<std::mutex> lock(g_mutex_serverList);
+	return g_ua_serverList;
+}
+
 void serverListClear() {
 	const std::lock_guard<std::mutex> lock(g_mutex_serverList);
 	g_ua_serverList.clear();
@@ -1837,45 +2074,130 @@ Uint32 timerCallbackReconnect(Uint32 interval, void* param) //g_timer_network_re
 	return interval;
 }
 
-Uint32 timerCallbackNetworkTimeout(Uint32 interval, void* param) //g_timer_network_timeout
-{
-	g_msg = "Network timeout";
-	writeLog(LOG_INFO, g_msg);
-	
-	pushEvent(EVENT_DISCONNECT);
+int64_t getNetworkTime() {
+	return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
 
-	setRedrawWindow(true);
-	SDL_RemoveTimer(g_timer_network_timeout);
-	g_timer_network_timeout = 0;
+// like RFC 6298: srtt = 7/8 srtt + 1/8 r, rttvar = 3/4 rttvar + 1/4 |srtt - r|, rto = srtt + 4 rttvar
+void addNetworkRttSample(int64_t rtt_us) {
+	const std::lock_guard<std::mutex> lock(g_mutex_networkRtt);
+	g_networkRttMin = g_networkRttSamples ? min(g_networkRttMin, rtt_us) : rtt_us;
+	g_networkRttMax = max(g_networkRttMax, rtt_us);
+	g_networkRttSum += rtt_us;
+	g_networkRttSamples++;
 
-	// try to reconnect
-	if (g_settings.reconnect_time && g_timer_network_reconnect == 0) {
-		g_timer_network_reconnect = SDL_AddTimer(g_settings.reconnect_time, timerCallbackReconnect, NULL);
+	if (g_networkSrtt < 0) {
+		g_networkSrtt = rtt_us;
+		g_networkRttvar = rtt_us / 2;
+	}
+	else {
+		g_networkRttvar = (3 * g_networkRttvar + abs(g_networkSrtt - rtt_us)) / 4;
+		g_networkSrtt = (7 * g_networkSrtt + rtt_us) / 8;
 	}
 
-	return 0;
+	int rto = (int)((g_networkSrtt + 4 * g_networkRttvar) / 1000);
+	g_networkRto = max(NETWORK_RTO_MIN, min(NETWORK_RTO_MAX, rto));
+}
+
+void onNetworkProbeAnswer() {
+	int64_t probe = g_networkProbePending.exchange(0);
+	if (probe != 0) {
+		addNetworkRttSample((getNetworkTime() - probe) * 1000);
+	}
+}
+
+// probes are sent often enough to keep the rtt measured, but not more often than every 4 rto
+int getNetworkProbeInterval() {
+	return max(NETWORK_PROBE_MIN, min(NETWORK_PROBE_TIME, 4 * g_networkRto));
+}
+
+// silence allowed after the probe interval for the answer to arrive
+int getNetworkTimeout() {
+	return min(NETWORK_TIMEOUT, getNetworkProbeInterval() + max(NETWORK_TIMEOUT_MIN, 3 * g_networkRto));
+}
+
+// ms until the watchdog has something to do: the silence times out, the pending probe is lost or
+// the next probe is due; frames arriving meanwhile only move these deadlines later
+Uint32 getNetworkWatchdogDelay(int64_t now) {
+	int timeout = getNetworkTimeout();
+	int64_t probeDue = g_networkLastProbe + getNetworkProbeInterval();
+	int64_t pending = g_networkProbePending;
+	int64_t next = g_networkLastFrame.load(memory_order_relaxed) + timeout;
+	if (pending != 0) {
+		next = min(next, pending + timeout);
+	}
+	if (pending == 0 || probeDue > now) { // an answer in time makes the next probe due then
+		next = min(next, probeDue);
+	}
+	return (Uint32)max((int64_t)1, next - now);
 }
 
-Uint32 timerCallbackNetworkSendTimeoutMsg(Uint32 interval, void* param) //g_timer_network_timeout
+Uint32 timerCallbackNetworkWatchdog(Uint32 interval, void* param) //g_timer_network_watchdog
 {
-	tcpClientSend("get /devices/0/Name/"); // just ask for sth to check if the connection is alive
-	SDL_RemoveTimer(g_timer_network_send_timeout_msg);
-	g_timer_network_send_timeout_msg = 0;
+	int64_t now = getNetworkTime();
+	int64_t lastFrame = g_networkLastFrame.load(memory_order_relaxed);
+	int timeout = getNetworkTimeout();
 
-	return 0;
+	if (now - lastFrame >= timeout) {
+		g_msg = "Network timeout";
+		writeLog(LOG_INFO, g_msg + " after " + to_string(now - lastFrame) + " ms (rto " + to_string(g_networkRto.load()) + " ms)");
+
+		pushEvent(EVENT_DISCONNECT, (void*)(intptr_t)true); // keep the model for the reconnect
+
+		setRedrawWindow(true);
+		g_timer_network_watchdog = 0;
+
+		// try to reconnect
+		if (g_settings.reconnect_time && g_timer_network_reconnect == 0) {
+			g_timer_network_reconnect = SDL_AddTimer(g_settings.reconnect_time, timerCallbackReconnect, NULL);
+		}
+
+		return 0;
+	}
+
+	// the probe got lost while other frames still arrive, back off like tcp and send a new one
+	int64_t pending = g_networkProbePending;
+	if (pending != 0 && now - pending >= timeout && g_networkProbePending.compare_exchange_strong(pending, 0)) {
+		g_networkRto = min(NETWORK_RTO_MAX, 2 * g_networkRto);
+	}
+
+	// one probe at a time, the answer updates g_networkLastFrame and the rtt
+	if (now - g_networkLastProbe >= getNetworkProbeInterval() && g_networkProbePending == 0) {
+		g_networkLastProbe = now;
+		g_networkProbePending = now;
+		tcpClientSend("get /devices/0/Name/"); // just ask for sth to check if the connection is alive
+	}
+
+	return getNetworkWatchdogDelay(now);
 }
 
-void setNetworkTimeout() {
+void startNetworkWatchdog(unsigned int connect_rtt_us) {
+	g_networkLastFrame = getNetworkTime();
+	g_networkLastProbe = g_networkLastFrame.load();
+	g_networkProbePending = 0;
+	g_mutex_networkRtt.lock();
+	g_networkSrtt = -1;
+	g_networkRttvar = 0;
+	g_networkRto = NETWORK_RTO_INITIAL;
+	g_networkRttMin = 0;
+	g_networkRttMax = 0;
+	g_networkRttSum = 0;
+	g_networkRttSamples = 0;
+	g_mutex_networkRtt.unlock();
+	if (connect_rtt_us > 0) {
+		addNetworkRttSample(connect_rtt_us); // the tcp handshake is the first sample
+	}
 
-	if (g_timer_network_send_timeout_msg != 0) {
-		SDL_RemoveTimer(g_timer_network_send_timeout_msg);
+	if (g_timer_network_watchdog == 0) {
+		g_timer_network_watchdog = SDL_AddTimer(getNetworkWatchdogDelay(getNetworkTime()), timerCallbackNetworkWatchdog, NULL);
 	}
-	g_timer_network_send_timeout_msg = SDL_AddTimer(4000, timerCallbackNetworkSendTimeoutMsg, NULL);
+}
 
-	if (g_timer_network_timeout != 0) {
-		SDL_RemoveTimer(g_timer_network_timeout);
+void stopNetworkWatchdog() {
+	if (g_timer_network_watchdog != 0) {
+		SDL_RemoveTimer(g_timer_network_watchdog);
+		g_timer_network_watchdog = 0;
 	}
-	g_timer_network_timeout = SDL_AddTimer(10000, timerCallbackNetworkTimeout, NULL);
 }
 
 int SDLCALL muteAllThread(void* param) {
@@ -1931,6 +2253,133 @@ int SDLCALL muteAllThread(void* param) {
 	return 0;
 }
 
+// detached threads of the network (server list, connects), cleanUp() waits for them
+// before the network and the gui go away
+atomic<int> g_networkThreads;
+
+struct NetworkThread {
+	SDL_ThreadFunction fn;
+	void *param;
+};
+
+int SDLCALL networkThread(void *param)
+{
+	NetworkThread *thread = (NetworkThread*)param;
+	int result = thread->fn(thread->param);
+	delete thread;
+	g_networkThreads--;
+	return result;
+}
+
+bool startNetworkThread(SDL_ThreadFunction fn, const char *name, void *param) {
+	NetworkThread *thread = new NetworkThread;
+	thread->fn = fn;
+	thread->param = param;
+	g_networkThreads++;
+	SDL_Thread *handle = SDL_CreateThread(networkThread, name, (void*)thread);
+	if (!handle) {
+		g_networkThreads--;
+		delete thread;
+		return false;
+	}
+	SDL_DetachThread(handle);
+	return true;
+}
+
+void waitForNetworkThreads() {
+	while (g_networkThreads > 0) {
+		SDL_Delay(10);
+	}
+}
+
+struct ServerScan {
+	uint32_t first;
+	uint32_t count;
+};
+
+mutex g_mutex_serverNameLookups;
+vector<SDL_Thread*> g_serverNameLookupThreads;
+
+int SDLCALL serverNameLookupThread(void *param)
+{
+	string *ip = (string*)param;
+	string name = TCPClient::getComputerNameByIP(*ip);
+	if (name != *ip) {
+		g_serverCache.setName(*ip, name);
+	}
+	serverListAdd(name);
+	delete ip;
+
+	pushEvent(EVENT_UPDATE_CONNECT_BUTTONS);
+
+	return 0;
+}
+
+void onServerFound(const string &ip, unsigned int rtt)
+{
+	// called by the scanner as soon as a server answers, so resolve its name in parallel
+	writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Server found on " + ip + " (" + to_string(rtt) + " us)");
+	g_serverCache.seen(ip, rtt);
+
+	string *param = new string(ip);
+	SDL_Thread *thread = SDL_CreateThread(serverNameLookupThread, "serverNameLookupThread", (void*)param);
+	if (thread) {
+		const std::lock_guard<std::mutex> lock(g_mutex_serverNameLookups);
+		g_serverNameLookupThreads.push_back(thread);
+	}
+	else {
+		delete param;
+		serverListAdd(ip);
+		pushEvent(EVENT_UPDATE_CONNECT_BUTTONS);
+	}
+}
+
+void onCachedServerFound(const string &ip, unsigned int rtt)
+{
+	// the name is known from the last run, so the connect button shows up right away
+	string name = g_serverCache.getName(ip);
+	if (name.empty()) {
+		onServerFound(ip, rtt);
+		return;
+	}
+
+	writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Cached server " + name + " found on " + ip + " (" + to_string(rtt) + " us)");
+	g_serverCache.seen(ip, rtt);
+	serverListAdd(name);
+	pushEvent(EVENT_UPDATE_CONNECT_BUTTONS);
+}
+
+void waitForServerNameLookups()
+{
+	vector<SDL_Thread*> lookupThreads;
+	g_mutex_serverNameLookups.lock();
+	lookupThreads.swap(g_serverNameLookupThreads);
+	g_mutex_serverNameLookups.unlock();
+	for (auto it = lookupThreads.begin(); it != lookupThreads.end(); ++it) {
+		SDL_WaitThread(*it, NULL);
+	}
+}
+
+void onServerScanProgress(unsigned int probed)
+{
+	g_serverScanProbed += probed;
+}
+
+int SDLCALL scanServersThread(void *param)
+{
+	ServerScan *scan = (ServerScan*)param;
+
+	writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Scanning " + TCPClient::addressToString(scan->first) + " - "
+		+ TCPClient::addressToString(scan->first + scan->count - 1));
+
+	vector<string> serverList;
+	TCPClient::lookUpServers(scan->first, scan->count, UA_TCP_PORT, SERVER_TEST_TIMEOUT,
+		(int)g_settings.discovery_probes, (int)g_settings.discovery_rate, serverList, onServerFound, onServerScanProgress);
+	delete scan;
+
+	return 0;
+}
+
 int SDLCALL getServerListThread(void *param)
 {
 	if (g_serverlist_defined)
@@ -1951,38 +2400,87 @@ int SDLCALL getServerListThread(void *param)
 	if(g_timer_network_serverlist == 0)
 		g_timer_network_serverlist = SDL_AddTimer(1000, timerCallbackRefreshServerList, NULL);
 
-	vector<string> ips;
-	if (!TCPClient::getClientIPs(ips))
+	vector<IPv4Interface> interfaces;
+	if (!TCPClient::getClientInterfaces(interfaces))
 		return false;
 
 	setRedrawWindow(true);
-	
-#ifndef __linux__
-	vector<string> serverList;
-	TCPClient::lookUpServers("127.0.0.", 1, 2, UA_TCP_PORT, SERVER_TEST_TIMEOUT, serverList);
-	if (!serverList.empty()) {
-		for (auto itSL = serverList.begin(); itSL != serverList.end(); ++itSL) {
-			serverListAdd(TCPClient::getComputerNameByIP(*itSL));
+
+	// servers seen on previous runs are probed first, the sweep only runs if none of them answers
+	vector<uint32_t> cached;
+	vector<CachedServer> cachedServers = g_serverCache.get();
+	for (auto it = cachedServers.begin(); it != cachedServers.end(); ++it) {
+		uint32_t address;
+		if (TCPClient::stringToAddress(it->address, address)) {
+			cached.push_back(address);
 		}
-		pushEvent(EVENT_UPDATE_CONNECT_BUTTONS);
 	}
-#endif
 
-	for (auto it = ips.begin(); it != ips.end(); ++it) {
-		if ((*it).substr(0, 4) != "127.") {
-			size_t cut = (*it).find_last_of('.');
-			if (cut != string::npos) {
-				vector<string> serverList;
-				TCPClient::lookUpServers((*it).substr(0, cut + 1), 1, 255, UA_TCP_PORT, SERVER_TEST_TIMEOUT, serverList);
-				if (!serverList.empty()) {
-					for (auto itSL = serverList.begin(); itSL != serverList.end(); ++itSL) {
-						serverListAdd(TCPClient::getComputerNameByIP(*itSL));
-					}
-					pushEvent(EVENT_UPDATE_CONNECT_BUTTONS);
-				}
+	vector<string> serverList;
+	if (!cached.empty()) {
+		g_serverScanProbed = 0;
+		g_serverScanTotal = (unsigned int)cached.size();
+		TCPClient::lookUpServers(cached, UA_TCP_PORT, SERVER_CACHE_TIMEOUT, (int)cached.size(), 0, serverList,
+			onCachedServerFound, onServerScanProgress);
+		waitForServerNameLookups();
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  " + to_string(serverList.size()) + " of " + to_string(cached.size()) + " cached servers answered");
+	}
+
+	vector<ServerScan> scans;
+#ifndef __linux__
+	scans.push_back({ 0x7F000001, 1 }); // 127.0.0.1
+#endif
+	for (auto it = interfaces.begin(); it != interfaces.end(); ++it) {
+		if ((it->address >> 24) == 127) {
+			continue;
+		}
+		uint32_t netmask = max(it->netmask, (uint32_t)SERVER_SCAN_MIN_NETMASK);
+		if (netmask > 0xFFFFFFFC) { // point to point, no hosts to scan
+			continue;
+		}
+		// all hosts without network and broadcast address
+		ServerScan scan = { (it->address & netmask) + 1, ~netmask - 1 };
+		bool exists = false;
+		for (auto itS = scans.begin(); itS != scans.end(); ++itS) {
+			if (itS->first == scan.first) {
+				exists = true;
+				break;
 			}
 		}
+		if (!exists) {
+			scans.push_back(scan);
+		}
+	}
+
+	if (!serverList.empty()) {
+		scans.clear();
+	}
+
+	g_serverScanProbed = 0;
+	g_serverScanTotal = 0;
+	for (auto it = scans.begin(); it != scans.end(); ++it) {
+		g_serverScanTotal += it->count;
+	}
+
+	// scan all interfaces at once, found servers show up while the others are still running
+	vector<SDL_Thread*> scanThreads;
+	for (auto it = scans.begin(); it != scans.end(); ++it) {
+		ServerScan *scan = new ServerScan(*it);
+		SDL_Thread *thread = SDL_CreateThread(scanServersThread, "scanServersThread", (void*)scan);
+		if (thread) {
+			scanThreads.push_back(thread);
+		}
+		else {
+			scanServersThread((void*)scan);
+		}
+	}
+	for (auto it = scanThreads.begin(); it != scanThreads.end(); ++it) {
+		SDL_WaitThread(*it, NULL);
 	}
+	waitForServerNameLookups();
+
+	g_serverCache.save(getPrefPath(SERVER_CACHE_FILE));
+
 	g_btnSimulation->setVisible(g_ua_serverList.empty());
 	setRedrawWindow(true);
 
@@ -1993,1180 +2491,2141 @@ int SDLCALL getServerListThread(void *param)
 
 void getServerList() {
 
-    SDL_CreateThread(getServerListThread, "getServerListThread", NULL);
+    startNetworkThread(getServerListThread, "getServerListThread", NULL);
 }
 
-void tcpClientProc(int msg, const string &data)
-{
-	switch (msg)
-	{
-	case MSG_CLIENT_CONNECTED:
-		break;
-	case MSG_CLIENT_DISCONNECTED:
-		break;
-	case MSG_CLIENT_CONNECTION_LOST:
-	{
-		// try to reconnect
-		if (g_settings.reconnect_time && g_timer_network_reconnect == 0) {
-			g_timer_network_reconnect = SDL_AddTimer(g_settings.reconnect_time, timerCallbackReconnect, NULL);
-		}
+static_assert(FRAME_BUFFER_PADDING >= SIMDJSON_PADDING, "the receive buffer must keep the padding simdjson reads behind a frame");
 
-		//send message disconnect
-		pushEvent(EVENT_DISCONNECT);
-		break;
-	}
-	case MSG_TEXT:
-	{
-		setNetworkTimeout();
+// Parses a received frame in place: the frame buffer (and the replay) keeps FRAME_BUFFER_PADDING
+// readable bytes behind every frame, and every receiving thread reuses its parser and its buffers.
+// The element is valid until the next call on the same thread.
+dom::parser &getFrameParser() { // one per receiving thread
+	thread_local dom::parser parser;
+	return parser;
+}
 
-		if (g_settings.extended_logging) {
-			string tcp_msg = data;
-			writeLog(LOG_INFO | LOG_EXTENDED, "UA <- " + json_workaround_secure_unicode_characters(tcp_msg));
-		}
-		
-		string path_parameter[12];
+simdjson_result<dom::element> parseFrame(string_view data) {
+	return getFrameParser().parse((const uint8_t*)data.data(), data.length(), false);
+}
 
-		try
-		{
-			dom::parser parser;
-			padded_string json = padded_string(data);
-
-			//path
-			dom::element element = parser.parse(json); // parse a string
-			string_view sv = element["path"];
-			string path{ sv };
-
-			//path aufsplitten
-			size_t i = 0;
-			size_t lpos = 1;
-			do
-			{
-				size_t rpos = path.find_first_of('/', lpos);
-				if (rpos != string::npos)
-				{
-					path_parameter[i] = path.substr(lpos, rpos - lpos);
-					i++;
-				}
-				else
-				{
-					path_parameter[i] = path.substr(lpos);
-					break;
-				}
-				lpos = rpos + 1;
-			} while (lpos != string::npos && i < 12);
+size_t getMalformedFrames() {
+	return g_framesInvalidJson.load() + g_framesWithoutPath.load() + g_framesInvalidData.load();
+}
 
-			//daten anhand path_parameter verarbeiten
-			if (path_parameter[0] == "Session" || path_parameter[0] == "IOMapPreset") {
-				if (!isLoading()) {
-					pushEvent(EVENT_DEVICES_INITIATE_RELOAD);
-				}
-			}
-			else if (path_parameter[0] == "PostFaderMetering") {
-				pushEvent(EVENT_POST_FADER_METERING, (void*)(bool)element["data"]);
-			}
-			else if (path_parameter[0] == "devices") // devices laden
-			{
-				if (path_parameter[1].length() == 0)
-				{
-					const dom::object obj = element["data"]["children"];
-					vector<string>* strDevices = new vector<string>();
-					for (dom::object::iterator it = obj.begin(); it != obj.end(); ++it) {
-						string id{ it.key() };
-						strDevices->push_back(id);
-					}
-					pushEvent(EVENT_DEVICES_LOAD, (void*)strDevices);
-				}
-				else if (path_parameter[2] == "DeviceOnline") {
-					pushEvent(EVENT_DEVICE_ONLINE, (void*)new string(path_parameter[1]), (void*)(bool)element["data"]);
-				}
-				else if (path_parameter[2] == "CueBusCount") {
-					int *cueBusCount = new int;
-					*cueBusCount = (int)((int64_t)element["data"]);
-					pushEvent(EVENT_SENDS_LOAD, (void*)cueBusCount);
-				}
-				else if (path_parameter[2] == "inputs" || path_parameter[2] == "auxs" || path_parameter[2] == "outputs")
-				{
-					if (path_parameter[3].length() == 0) {
+void resetMalformedFrames() {
+	g_framesInvalidJson = 0;
+	g_framesWithoutPath = 0;
+	g_framesInvalidData = 0;
+	g_framesMalformedLogged = 0;
+}
 
-						const dom::object obj = element["data"]["children"];
+// reads "data" of a received frame, a value of another type is counted as malformed
+template<typename T> bool getRouteData(dom::element element, T &value) {
+	if (element["data"].get(value) != SUCCESS) {
+		g_framesInvalidData++;
+		return false;
+	}
+	return true;
+}
 
-						vector<string>* pIds = new vector<string>();
-						for (dom::object::iterator it = obj.begin(); it != obj.end(); ++it) {
-							string id{ it.key() };
-							pIds->push_back(id);
-						}
+bool getChildren(dom::element element, vector<string> &ids) {
+	dom::object obj;
+	if (element["data"]["children"].get(obj) != SUCCESS) {
+		g_framesInvalidData++;
+		return false;
+	}
+	for (dom::object::iterator it = obj.begin(); it != obj.end(); ++it) {
+		string id{ it.key() };
+		ids.push_back(id);
+	}
+	return true;
+}
 
-						string* devStr = new string(path_parameter[1]);
-						if (path_parameter[2] == "inputs") {
-							pushEvent(EVENT_INPUTS_LOAD, (void*)pIds, (void*)devStr);
-						}
-						else if (path_parameter[2] == "auxs") {
-							pushEvent(EVENT_AUXS_LOAD, (void*)pIds, (void*)devStr);
-						}
-						else if (path_parameter[2] == "outputs") {
-							pushEvent(EVENT_OUTPUTS_LOAD, (void*)pIds, (void*)devStr);
-						}
-					}
-					else {
+// route handlers of tcpClientProc, captures: device, channel[, send][, meter]
 
-						int type = 0;
-						if (path_parameter[2] == "inputs") {
-							type = INPUT;
-						}
-						else if (path_parameter[2] == "auxs") {
-							type = AUX;
-						}
-						else if (path_parameter[2] == "outputs") {
-							type = MASTER;
-						}
-						Channel* channel = getChannelByUAIds(path_parameter[1], path_parameter[3], type);
-						if (channel)
-						{
-							if (path_parameter[4] == "sends")//input sends
-							{
-								if (path_parameter[5].length() != 0)
-								{
-									Send* send = channel->getSendByUAId(path_parameter[5]);
-									if (send)
-									{
-										if (path_parameter[6] == "meters")
-										{
-											if (path_parameter[7] == "0" && path_parameter[8] == "MeterLevel" && path_parameter[9] == "value")
-											{
-												double db = element["data"];
-												double prev_meter_level = send->meter_level;
-												send->meter_level = min(1.0, fromDbFS(db));
-												if (db >= METER_THRESHOLD &&
-													((int)(toMeterScale(prev_meter_level) * UA_METER_PRECISION)) != ((int)(toMeterScale(send->meter_level) * UA_METER_PRECISION))) {
-													setRedrawWindow(true);
-												}
-											}
+void onRouteSessionChanged(const PathMatch &match, dom::element element) {
+	if (!isLoading()) {
+		pushEvent(EVENT_DEVICES_INITIATE_RELOAD);
+	}
+}
 
-											if (path_parameter[7] == "0" && path_parameter[8] == "MeterClip" && path_parameter[9] == "value")
-											{
-												send->clip = element["data"];
-												setRedrawWindow(true);
-											}
+void onRoutePostFaderMetering(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushEvent(EVENT_POST_FADER_METERING, (void*)value);
+	}
+}
 
-											if (path_parameter[7] == "1" && path_parameter[8] == "MeterLevel" && path_parameter[9] == "value")
-											{
-												double db = element["data"];
-												double prev_meter_level2 = send->meter_level2;
-												send->meter_level2 = min(1.0, fromDbFS(db));
-												if (db >= METER_THRESHOLD &&
-													((int)(toMeterScale(prev_meter_level2) * UA_METER_PRECISION)) != ((int)(toMeterScale(send->meter_level2) * UA_METER_PRECISION))) {
-													setRedrawWindow(true);
-												}
-											}
+void onRouteDevices(const PathMatch &match, dom::element element) {
+	vector<string>* strDevices = new vector<string>();
+	if (!getChildren(element, *strDevices)) {
+		delete strDevices;
+		return;
+	}
+	pushEvent(EVENT_DEVICES_LOAD, (void*)strDevices);
+}
 
-											if (path_parameter[7] == "1" && path_parameter[8] == "MeterClip" && path_parameter[9] == "value")
-											{
-												send->clip2 = element["data"];
-												setRedrawWindow(true);
-											}
-										}
-										else if (path_parameter[6] == "Gain" && channel->touch_point.action != TOUCH_ACTION_LEVEL)//sends
-										{
-											if (path_parameter[7] == "value")
-											{
-												send->level = fromDbFS(element["data"]);
-												setRedrawWindow(true);
-											}
-										}
-										else if (path_parameter[6] == "Pan" && channel->touch_point.action != TOUCH_ACTION_PAN)//sends
-										{
-											if (path_parameter[7] == "value")
-											{
-												send->pan = element["data"];
-												setRedrawWindow(true);
-											}
-										}
-										else if (path_parameter[6] == "Bypass")//sends
-										{
-											if (path_parameter[7] == "value")
-											{
-												send->mute = element["data"];
-												setRedrawWindow(true);
-											}
-										}
-									}
-								}
-							}
-							else if (path_parameter[4] == "meters")
-							{
-								if (path_parameter[5] == "0" && path_parameter[6] == "MeterLevel" && path_parameter[7] == "value")
-								{
-									double db = element["data"];
-									double prev_meter_level = channel->meter_level;
-									channel->meter_level = min(1.0, fromDbFS(db));
-									if (db >= METER_THRESHOLD &&
-										((int)(toMeterScale(prev_meter_level) * UA_METER_PRECISION)) != ((int)(toMeterScale(channel->meter_level) * UA_METER_PRECISION))) {
-										setRedrawWindow(true);
-									}
-								}
-								if (path_parameter[5] == "0" && path_parameter[6] == "MeterClip" && path_parameter[7] == "value")
-								{
-									channel->clip = element["data"];
-									setRedrawWindow(true);
-								}
-								if (path_parameter[5] == "1" && path_parameter[6] == "MeterLevel" && path_parameter[7] == "value")
-								{
-									double db = element["data"];
-									double prev_meter_level2 = channel->meter_level2;
-									channel->meter_level2 = min(1.0, fromDbFS(db));
-									if (db >= METER_THRESHOLD &&
-										((int)(toMeterScale(prev_meter_level2) * UA_METER_PRECISION)) != ((int)(toMeterScale(channel->meter_level2) * UA_METER_PRECISION))) {
-										setRedrawWindow(true);
-									}
-								}
-								if (path_parameter[5] == "1" && path_parameter[6] == "MeterClip" && path_parameter[7] == "value")
-								{
-									channel->clip2 = element["data"];
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "FaderLevel" && channel->touch_point.action != TOUCH_ACTION_LEVEL)
-							{
-								if (path_parameter[5] == "value")
-								{
-									channel->level = fromDbFS((double)element["data"]);
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "CRMonitorLevel" && channel->touch_point.action != TOUCH_ACTION_LEVEL)
-							{
-								if (path_parameter[5] == "value")
-								{
-									double dBlevel = (double)element["data"];
-									if (dBlevel > -96.0) {
-										channel->level = fromDbFS(dBlevel);
-									}
-									else {
-										channel->level = fromDbFS(-144.0);
-									}
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "Name") {
-								if (path_parameter[5] == "value") {
+void onRouteDeviceOnline(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushEvent(EVENT_DEVICE_ONLINE, (void*)new string(match.segment[0]), (void*)value);
+	}
+}
 
-									string_view sv = element["data"];
-									string value{ sv };
-									channel->setName(unescape_to_utf8(value));
-								}
-							}
-							else if (path_parameter[4] == "Pan" && channel->touch_point.action != TOUCH_ACTION_PAN)
-							{
-								if (path_parameter[5] == "value")
-								{
-									channel->pan = element["data"];
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "Pan2" && channel->touch_point.action != TOUCH_ACTION_PAN2)
-							{
-								if (path_parameter[5] == "value")
-								{
-									channel->pan2 = element["data"];
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "Solo")
-							{
-								if (path_parameter[5] == "value")
-								{
-									channel->solo = element["data"];
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "SendPostFader")
-							{
-								if (path_parameter[5] == "value")
-								{
-									channel->post_fader = element["data"];
-									setRedrawWindow(true);
-								}
-							}
-							else if (path_parameter[4] == "Mute")
-							{
-								if (path_parameter[5] == "value")
-								{
-									bool result;
-									if (element["data"].get(result) == 0) {
-										channel->mute = result;
-										if (channel->type == AUX || channel->type == MASTER) {
-											if (!channel->active) {
-												channel->active = true;
-												pushEvent(EVENT_CHANNEL_STATE_CHANGED);
-											}
-										}
-										setRedrawWindow(true);
-									}
-								}
-							}
-							else if (path_parameter[4] == "Stereo") {
-								if (path_parameter[5] == "value") {
-									bool result;
-									if (element["data"].get(result) == 0) {
-										g_activeChannelsCount = -1;
-										g_visibleChannelsCount = -1;
-										channel->setStereo(result);
-									}
-								}
-							}
-							else if (path_parameter[4] == "StereoName") {
-								if (path_parameter[5] == "value") {
-									string_view sv;
-									if (element["data"].get(sv) == 0) {
-										string value{ sv };
-										channel->setStereoname(unescape_to_utf8(value));
-									}
-								}
-							}
-							else if (path_parameter[4] == "ChannelHidden")
-							{
-								if (path_parameter[5] == "value")
-								{
-									bool result;
-									if (element["data"].get(result) == 0) {
-										channel->hidden = result;
-										pushEvent(EVENT_CHANNEL_STATE_CHANGED);
-									}
-								}
-							}
-							else if (path_parameter[4] == "EnabledByUser")
-							{
-								if (path_parameter[5] == "value")
-								{
-									bool result;
-									if (element["data"].get(result) == 0) {
-										channel->enabledByUser = result;
-										pushEvent(EVENT_CHANNEL_STATE_CHANGED);
-									}
-								}
-							}
-							else if (path_parameter[4] == "Active")
-							{
-								if (path_parameter[5] == "value")
-								{
-									bool result;
-									if (element["data"].get(result) == 0) {
-										channel->active = result;
-										pushEvent(EVENT_CHANNEL_STATE_CHANGED);
-									}
-								}
-							}
-						}
-						else {
-							writeLog(LOG_ERROR | LOG_EXTENDED, "Channel was NULL");
-						}
-					}
-				}
-			}
+void onRouteCueBusCount(const PathMatch &match, dom::element element) {
+	int64_t value;
+	if (getRouteData(element, value)) {
+		int *cueBusCount = new int;
+		*cueBusCount = (int)value;
+		pushEvent(EVENT_SENDS_LOAD, (void*)cueBusCount);
+	}
+}
 
-			try {
-				//ua-error
-				const char *c;
-				if (element["error"].get_c_str().get(c) == SUCCESS) {
-					writeLog(LOG_ERROR| LOG_EXTENDED, "UA-Error " + string(c));
-				}
-			}
-			catch (const simdjson_error&) {}
-		}
-		catch (const simdjson_error &e) {
-			writeLog(LOG_ERROR| LOG_EXTENDED, "JSON-Error: " + string(e.what()));
-		}
-		break;
+void onRouteChannels(const PathMatch &match, dom::element element) {
+	vector<string>* pIds = new vector<string>();
+	if (!getChildren(element, *pIds)) {
+		delete pIds;
+		return;
 	}
+
+	string* devStr = new string(match.segment[0]);
+	if (match.tag == INPUT) {
+		pushEvent(EVENT_INPUTS_LOAD, (void*)pIds, (void*)devStr);
+	}
+	else if (match.tag == AUX) {
+		pushEvent(EVENT_AUXS_LOAD, (void*)pIds, (void*)devStr);
+	}
+	else if (match.tag == MASTER) {
+		pushEvent(EVENT_OUTPUTS_LOAD, (void*)pIds, (void*)devStr);
 	}
 }
 
-void tcpClientSend(const string &msg) {
-	if (g_btnSimulation && g_btnSimulation->isHighlighted()) {
+// values for channels and sends are only queued here, the main loop applies them by applyModelUpdates();
+// the ids are resolved there, so a channel deleted meanwhile is no problem
+void pushModelUpdate(const PathMatch &match, int property, double value, string &&name = string()) {
+	ModelUpdate update;
+	update.property = property;
+	update.type = match.tag;
+	update.device = match.value[0];
+	update.channel = match.value[1];
+	update.send = match.count > 2 ? match.value[2] : 0;
+	update.value = value;
+	update.name = std::move(name);
+	if (!g_modelOverflowing.load(memory_order_acquire) && g_modelUpdates.push(std::move(update))) {
 		return;
 	}
+	const std::lock_guard<std::mutex> lock(g_mutex_modelOverflow);
+	g_modelOverflow.push_back(std::move(update));
+	g_modelOverflowing.store(true, memory_order_release);
+}
 
-	if (g_tcpClient) {
-		writeLog(LOG_INFO| LOG_EXTENDED, "UA -> " + msg);
-		g_tcpClient->send(msg);
+void onRouteSendGain(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_SEND_GAIN, value);
 	}
 }
 
-void drawScaleMark(float x, float y, int scale_value, double total_scale) {
-	Vector2D sz = gfx->GetTextBlockSize(g_fntFaderScale, "-1234567890");
-	double v = fromDbFS((double)scale_value);
-	y = y - (float)(toMeterScale(v) * total_scale) + (float)total_scale;
+void onRouteSendPan(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_SEND_PAN, value);
+	}
+}
 
-	gfx->DrawShape(GFX_RECTANGLE, RGB(170, 170, 170), x + g_channel_width * 0.25f, y, g_channel_width * 0.1f, 1.0f, GFX_NONE, 0.8f);
-	gfx->Write(g_fntFaderScale, x + g_channel_width * 0.24f, y - sz.getY() * 0.5f, to_string(scale_value), GFX_RIGHT, NULL, GFX_NONE, 0.8f);
+void onRouteSendBypass(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_SEND_BYPASS, value ? 1.0 : 0.0);
+	}
 }
 
-Module* Channel::getModule(const string &mixBus) {
-	if (mixBus == "MIX") {
-		return (Module*)this;
+void onRouteFaderLevel(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_FADER_LEVEL, value);
 	}
-	else {
-		return this->getSendByName(mixBus);
+}
+
+void onRouteCRMonitorLevel(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_CR_MONITOR_LEVEL, value);
 	}
-	return NULL;
 }
 
-void Channel::draw(float _x, float _y, float _width, float _height) {
+void onRouteName(const PathMatch &match, dom::element element) {
+	string_view sv;
+	if (getRouteData(element, sv)) {
+		string value;
+		unescape_to_utf8(sv, value);
+		pushModelUpdate(match, MODEL_NAME, 0.0, std::move(value));
+	}
+}
 
-	float x = _x;
-	float y = _y;
-	float width = _width;
-	float height = _height;
+void onRoutePan(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_PAN, value);
+	}
+}
 
-	float SPACE_X = 2.0f;
-	float SPACE_Y = 2.0f;
+void onRoutePan2(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_PAN2, value);
+	}
+}
 
-	Vector2D sz;
-	Vector2D stretch;
+void onRouteSolo(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_SOLO, value ? 1.0 : 0.0);
+	}
+}
 
-	Module* mod = this->getModule(g_selectedMixBus);
-	string name = this->getName();
+void onRouteSendPostFader(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_SEND_POST_FADER, value ? 1.0 : 0.0);
+	}
+}
 
-	if (this->type == AUX) {
-		if (name == "AUX 1") {
-			name = g_settings.label_aux1;
-			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux1 == "AUX") {
-				name += " 1";
-			}
-		}
-		else if (name == "AUX 2") {
-			name = g_settings.label_aux2;
-			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux2 == "AUX") {
-				name += " 2";
-			}
-		}
+void onRouteMute(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_MUTE, value ? 1.0 : 0.0);
 	}
+}
 
-	bool gray = false;
-	bool highlight = false;
+void onRouteStereo(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_STEREO, value ? 1.0 : 0.0);
+	}
+}
 
-	bool btn_select = g_btnSelectChannels->isHighlighted();
+void onRouteStereoName(const PathMatch &match, dom::element element) {
+	string_view sv;
+	if (getRouteData(element, sv)) {
+		string value;
+		unescape_to_utf8(sv, value);
+		pushModelUpdate(match, MODEL_STEREO_NAME, 0.0, std::move(value));
+	}
+}
 
-	//SELECT CHANNELS
-	if (btn_select) {
-		if (!this->selected_to_show) {
-			gray = true;
-		}
-		else {
-			highlight = true;
-		}
+void onRouteChannelHidden(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_CHANNEL_HIDDEN, value ? 1.0 : 0.0);
 	}
+}
 
-	if(highlight) {
-		unsigned int clr = RGB(200, 200, 50);
+void onRouteEnabledByUser(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_ENABLED_BY_USER, value ? 1.0 : 0.0);
+	}
+}
 
-		Vector2D pt = {_x - 1, _y};
-		Channel *prev_channel = getChannelByPosition(pt);
-		if (!prev_channel || !prev_channel->selected_to_show) {
-			gfx->DrawShape(GFX_RECTANGLE, clr, _x - SPACE_X, 0, SPACE_X, _height * 1.02f, GFX_NONE, 0.5f); // links
-		}
+void onRouteActive(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushModelUpdate(match, MODEL_ACTIVE, value ? 1.0 : 0.0);
+	}
+}
 
-		gfx->DrawShape(GFX_RECTANGLE, clr, _x, 0, _width - SPACE_X, SPACE_Y, GFX_NONE, 0.5f); // oben
-		gfx->DrawShape(GFX_RECTANGLE, clr, _x, _height * 1.02f - SPACE_Y, _width - SPACE_X, SPACE_Y, GFX_NONE, 0.5f); // unten
-		gfx->DrawShape(GFX_RECTANGLE, clr, _x + _width - SPACE_X, 0, SPACE_X, _height * 1.02f, GFX_NONE, 0.5f); // rechts
+// meters that did not take the fast path of parseMeterFrame(), the last capture is the meter index
+void pushRouteMeter(const PathMatch &match, bool clip, double value) {
+	MeterFrame meter;
+	meter.device = match.value[0];
+	meter.type = match.tag;
+	meter.channel = match.value[1];
+	meter.send = match.count == 4 ? (int)match.value[2] : -1;
+	meter.meter = match.value[match.count - 1];
+	meter.clip = clip;
+	meter.value = value;
+	g_meterQueue.push(meter);
+}
+
+void onRouteMeterLevel(const PathMatch &match, dom::element element) {
+	double value;
+	if (getRouteData(element, value)) {
+		pushRouteMeter(match, false, value);
 	}
+}
 
-	GFXSurface *gsLabel = NULL, *gsFader = NULL;
-	this->getColoredGfx(&gsLabel, &gsFader);
+void onRouteMeterClip(const PathMatch &match, dom::element element) {
+	bool value;
+	if (getRouteData(element, value)) {
+		pushRouteMeter(match, true, value ? 1.0 : 0.0);
+	}
+}
 
-	if (mod) {
-		//LABEL überspringen und am Ende zeichenen (wg. asugrauen)
-		y += g_fader_label_height;
-		height -= g_fader_label_height;
+void initRoutes() {
+	g_routes.add("/Session/*", onRouteSessionChanged);
+	g_routes.add("/IOMapPreset/*", onRouteSessionChanged);
+	g_routes.add("/PostFaderMetering/*", onRoutePostFaderMetering);
+	g_routes.add("/devices", onRouteDevices);
+	g_routes.add("/devices/#/DeviceOnline/*", onRouteDeviceOnline);
+	g_routes.add("/devices/#/CueBusCount/*", onRouteCueBusCount);
 
-		if (this->type == INPUT) {
-			//PAN
-			//tracker
-			if (g_btnMix->isHighlighted() || !this->stereo) {
-				float pan_width = width;
-				if (this->stereo) {
-					pan_width /= 2;
-					float local_PAN_TRACKER_HEIGHT = pan_width;
-					if (local_PAN_TRACKER_HEIGHT > g_pantracker_height)
-						local_PAN_TRACKER_HEIGHT = g_pantracker_height;
+	const pair<string, int> types[] = { { "inputs", INPUT }, { "auxs", AUX }, { "outputs", MASTER } };
+	for (const pair<string, int> &type : types) {
+		string channel = "/devices/#/" + type.first + "/#";
+		g_routes.add("/devices/#/" + type.first, onRouteChannels, type.second);
+		g_routes.add(channel + "/sends/#/Gain/value", onRouteSendGain, type.second);
+		g_routes.add(channel + "/sends/#/Pan/value", onRouteSendPan, type.second);
+		g_routes.add(channel + "/sends/#/Bypass/value", onRouteSendBypass, type.second);
+		g_routes.add(channel + "/FaderLevel/value", onRouteFaderLevel, type.second);
+		g_routes.add(channel + "/CRMonitorLevel/value", onRouteCRMonitorLevel, type.second);
+		g_routes.add(channel + "/Name/value", onRouteName, type.second);
+		g_routes.add(channel + "/Pan/value", onRoutePan, type.second);
+		g_routes.add(channel + "/Pan2/value", onRoutePan2, type.second);
+		g_routes.add(channel + "/Solo/value", onRouteSolo, type.second);
+		g_routes.add(channel + "/SendPostFader/value", onRouteSendPostFader, type.second);
+		g_routes.add(channel + "/Mute/value", onRouteMute, type.second);
+		g_routes.add(channel + "/Stereo/value", onRouteStereo, type.second);
+		g_routes.add(channel + "/StereoName/value", onRouteStereoName, type.second);
+		g_routes.add(channel + "/ChannelHidden/value", onRouteChannelHidden, type.second);
+		g_routes.add(channel + "/EnabledByUser/value", onRouteEnabledByUser, type.second);
+		g_routes.add(channel + "/Active/value", onRouteActive, type.second);
 
-					stretch = Vector2D(local_PAN_TRACKER_HEIGHT, local_PAN_TRACKER_HEIGHT);
-					gfx->Draw(g_gsPan, x + pan_width + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
-						GFX_NONE, 1.0f, 0, NULL, &stretch);
+		g_routes.add(channel + "/meters/#/MeterLevel/value", onRouteMeterLevel, type.second);
+		g_routes.add(channel + "/meters/#/MeterClip/value", onRouteMeterClip, type.second);
+		g_routes.add(channel + "/sends/#/meters/#/MeterLevel/value", onRouteMeterLevel, type.second);
+		g_routes.add(channel + "/sends/#/meters/#/MeterClip/value", onRouteMeterClip, type.second);
+	}
+}
 
-					gfx->Draw(g_gsPanPointer, x + pan_width + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
-						GFX_NONE, 1.0f, DEG2RAD((float)mod->pan2 * 140.0f), NULL, &stretch);
+static_assert(METER_INPUT == INPUT && METER_AUX == AUX && METER_MASTER == MASTER, "MeterFrame uses the channel types");
+static_assert(METER_MAX_INDEX <= UA_MAX_INDEX, "the ids of the fast path have to fit into the channel table");
 
-					gfx->Draw(g_gsPan, x + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
-						GFX_NONE, 1.0f, 0, NULL, &stretch);
+void applyMeterValue(const MeterFrame &meter) {
+	if (meter.meter > 1) { // only left/mono and right are shown
+		return;
+	}
+	Module *module = getChannelByUAIndex(meter.device, meter.channel, meter.type);
+	if (module && meter.send != -1) {
+		module = ((Channel*)module)->getSendByUAIndex((unsigned)meter.send);
+	}
+	if (!module) {
+		return;
+	}
 
-					gfx->Draw(g_gsPanPointer, x + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
-						GFX_NONE, 1.0f, DEG2RAD((float)mod->pan * 140.0f), NULL, &stretch);
-				}
-				else {
-					stretch = Vector2D(g_pantracker_height, g_pantracker_height);
-					gfx->Draw(g_gsPan, x + (pan_width - g_pantracker_height) / 2.0f, y + (g_channel_pan_height - g_pantracker_height) / 2.0f, NULL,
-						GFX_NONE, 1.0f, 0, NULL, &stretch);
+	if (meter.clip) {
+		if (meter.meter == 1) {
+			module->clip2 = meter.value != 0.0;
+		}
+		else {
+			module->clip = meter.value != 0.0;
+		}
+		setRedrawWindow(true);
+	}
+	else {
+		double &meter_level = meter.meter == 1 ? module->meter_level2 : module->meter_level;
+		double prev_meter_level = meter_level;
+		meter_level = min(1.0, fromDbFS(meter.value));
+		if (meter.value >= METER_THRESHOLD &&
+			((int)(toMeterScale(prev_meter_level) * UA_METER_PRECISION)) != ((int)(toMeterScale(meter_level) * UA_METER_PRECISION))) {
+			setRedrawWindow(true);
+		}
+	}
+}
 
-					gfx->Draw(g_gsPanPointer, x + (pan_width - g_pantracker_height) / 2.0f, y + (g_channel_pan_height - g_pantracker_height) / 2.0f, NULL,
-						GFX_NONE, 1.0f, DEG2RAD((float)mod->pan * 140.0f), NULL, &stretch);
-				}
+// main loop, returns true if the window needs a redraw
+bool applyModelUpdate(const ModelUpdate &update, bool &channelStateChanged) {
+	Channel *channel = getChannelByUAIndex(update.device, update.channel, update.type);
+	if (!channel) {
+		writeLog(LOG_ERROR | LOG_EXTENDED, "Channel was NULL");
+		return false;
+	}
 
+	switch (update.property) {
+	case MODEL_SEND_GAIN:
+	case MODEL_SEND_PAN:
+	case MODEL_SEND_BYPASS:
+	{
+		Send *send = channel->getSendByUAIndex(update.send);
+		if (!send) {
+			return false;
+		}
+		if (update.property == MODEL_SEND_GAIN) {
+			if (channel->touch_point.action == TOUCH_ACTION_LEVEL) {
+				return false;
 			}
+			send->level = fromDbFS(update.value);
 		}
-
-		gfx->SetColor(g_fntMain, RGB(20, 20, 20));
-		gfx->SetColor(g_fntFaderScale, RGB(170, 170, 170));
-		gfx->SetColor(g_fntChannelBtn, RGB(80, 80, 80));
-
-		y += g_channel_pan_height;
-		height -= g_channel_pan_height;
-
-		float x_offset = (width / 2.0f - g_channel_btn_size) / 2.0f;
-		//SOLO
-		if (g_btnMix->isHighlighted()) {
-			int btn_switch = 0;
-			if ((this->type == AUX && !this->post_fader) || (this->type != AUX && this->solo)) {
-				btn_switch = 1;
+		else if (update.property == MODEL_SEND_PAN) {
+			if (channel->touch_point.action == TOUCH_ACTION_PAN) {
+				return false;
 			}
+			send->pan = update.value;
+		}
+		else {
+			send->mute = update.value != 0.0;
+		}
+		return true;
+	}
+	case MODEL_FADER_LEVEL:
+		if (channel->touch_point.action == TOUCH_ACTION_LEVEL) {
+			return false;
+		}
+		channel->level = fromDbFS(update.value);
+		return true;
+	case MODEL_CR_MONITOR_LEVEL:
+		if (channel->touch_point.action == TOUCH_ACTION_LEVEL) {
+			return false;
+		}
+		if (update.value > -96.0) {
+			channel->level = fromDbFS(update.value);
+		}
+		else {
+			channel->level = fromDbFS(-144.0);
+		}
+		return true;
+	case MODEL_NAME:
+		channel->setName(update.name);
+		return true;
+	case MODEL_PAN:
+		if (channel->touch_point.action == TOUCH_ACTION_PAN) {
+			return false;
+		}
+		channel->pan = update.value;
+		return true;
+	case MODEL_PAN2:
+		if (channel->touch_point.action == TOUCH_ACTION_PAN2) {
+			return false;
+		}
+		channel->pan2 = update.value;
+		return true;
+	case MODEL_SOLO:
+		channel->solo = update.value != 0.0;
+		return true;
+	case MODEL_SEND_POST_FADER:
+		channel->post_fader = update.value != 0.0;
+		return true;
+	case MODEL_MUTE:
+		channel->mute = update.value != 0.0;
+		if ((channel->type == AUX || channel->type == MASTER) && !channel->active) {
+			channel->active = true;
+			channelStateChanged = true;
+		}
+		return true;
+	case MODEL_STEREO:
+		g_activeChannelsCount = -1;
+		g_visibleChannelsCount = -1;
+		channel->setStereo(update.value != 0.0);
+		return true;
+	case MODEL_STEREO_NAME:
+		channel->setStereoname(update.name);
+		return true;
+	case MODEL_CHANNEL_HIDDEN:
+		channel->hidden = update.value != 0.0;
+		channelStateChanged = true;
+		return false;
+	case MODEL_ENABLED_BY_USER:
+		channel->enabledByUser = update.value != 0.0;
+		channelStateChanged = true;
+		return false;
+	case MODEL_ACTIVE:
+		channel->active = update.value != 0.0;
+		channelStateChanged = true;
+		return false;
+	}
+	return false;
+}
 
-			GFXSurface* gsBtn = g_gsButtonRed[btn_switch];
-			string txt = "S";
-			if (this->type == AUX) {
-				gsBtn = g_gsButtonBlue[btn_switch];
-				txt = "PRE";
+// main loop, once per round before drawing; all values received since the last round are applied
+// before one decision about redraw and subscriptions
+void applyModelUpdates() {
+	static vector<ModelUpdate> overflow;
+	bool redraw = false;
+	bool channelStateChanged = false;
+	ModelUpdate update;
+	size_t n = 0;
+	for (; n < MODEL_QUEUE_SIZE && g_modelUpdates.pop(update); n++) { // a flood must not stall the round
+		if (applyModelUpdate(update, channelStateChanged)) {
+			redraw = true;
+		}
+	}
+
+	// the overflow is newer than everything in the queue; once it is in use, the network thread
+	// does not put anything into the queue, so what is left there is applied first
+	if (n < MODEL_QUEUE_SIZE && g_modelOverflowing.load(memory_order_acquire)) {
+		while (g_modelUpdates.pop(update)) { // at most its capacity
+			if (applyModelUpdate(update, channelStateChanged)) {
+				redraw = true;
 			}
+		}
 
-			if (this->type != MASTER) {
-				stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
-				gfx->Draw(gsBtn, x + x_offset, y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+		g_mutex_modelOverflow.lock();
+		overflow.swap(g_modelOverflow);
+		g_modelOverflowing.store(false, memory_order_release);
+		g_mutex_modelOverflow.unlock();
 
-				sz = gfx->GetTextBlockSize(g_fntChannelBtn, txt, GFX_CENTER);
-				gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2, y + (g_channel_btn_size - sz.getY()) / 2, txt, GFX_CENTER);
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA <- overload, " + to_string(overflow.size()) + " values waited beside the full queue");
+		for (vector<ModelUpdate>::iterator it = overflow.begin(); it != overflow.end(); ++it) {
+			if (applyModelUpdate(*it, channelStateChanged)) {
+				redraw = true;
 			}
 		}
+		overflow.clear();
+	}
 
-		//MUTE
-		int btn_switch = 0;
-		if (mod->mute) {
-			btn_switch = 1;
+	if (channelStateChanged) {
+		pushEvent(EVENT_CHANNEL_STATE_CHANGED);
+	}
+	if (redraw) {
+		setRedrawWindow(true);
+	}
+}
+
+void discardModelUpdates() { // main loop, the values belong to a model that is gone
+	ModelUpdate update;
+	while (g_modelUpdates.pop(update)) {
+	}
+	const std::lock_guard<std::mutex> lock(g_mutex_modelOverflow);
+	g_modelOverflow.clear();
+	g_modelOverflowing.store(false, memory_order_release);
+}
+
+void applyMeterValues() { // main loop, once per round before drawing
+	if (g_meterQueue.take(g_meterValues) == 0) {
+		return;
+	}
+	for (vector<MeterFrame>::iterator it = g_meterValues.begin(); it != g_meterValues.end(); ++it) {
+		applyMeterValue(*it);
+	}
+
+	if (g_settings.extended_logging) {
+		MeterStats stats = g_meterQueue.getStats();
+		if (stats.dropped != g_meterDroppedLogged) {
+			writeLog(LOG_INFO | LOG_EXTENDED, "UA <- meter overload, " + to_string(stats.dropped - g_meterDroppedLogged) + " meter values dropped");
+			g_meterDroppedLogged = stats.dropped;
 		}
+	}
+}
 
-		stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
-		gfx->Draw(g_gsButtonYellow[btn_switch], x + x_offset + width / 2, y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+// recording, logging and the fast path for meters, returns true for a meter
+bool receiveFrame(string_view frame, MeterFrame &meter) {
+	if (g_recording) {
+		g_recorder.record(RECORD_RECEIVED, frame);
+	}
 
-		sz = gfx->GetTextBlockSize(g_fntChannelBtn, "M", GFX_CENTER);
-		gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2 + width / 2, y + (g_channel_btn_size - sz.getY()) / 2, "M", GFX_CENTER);
+	if (g_settings.extended_logging) {
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA <- " + json_workaround_secure_unicode_characters(frame));
+	}
 
-		y += g_channel_btn_size;
-		height -= g_channel_btn_size;
+	// meters are applied by the main loop, only the newest value per meter is kept until then;
+	// the bulk of them is read without the JSON parser
+	return parseMeterFrame(frame, meter);
+}
 
-		if (this->type != MASTER) {
-			//GROUPLABEL
-			float group_y = _height - g_channel_btn_size;
-			sz = gfx->GetTextBlockSize(g_fntFaderScale, "Group");
-			gfx->Write(g_fntFaderScale, x + g_channel_width / 2.0f, group_y - sz.getY() - SPACE_Y * 2.0f, "Group", GFX_CENTER, NULL, GFX_NONE, 0.9f);
+void dispatchFrame(dom::element element) {
+	//ua-error
+	const char *c;
+	if (element["error"].get_c_str().get(c) == SUCCESS) {
+		writeLog(LOG_ERROR| LOG_EXTENDED, "UA-Error " + string(c));
+	}
 
-			//GROUP1
-			btn_switch = 0;
-			if (this->fader_group == 1) {
-				btn_switch = 1;
-			}
+	//path
+	string_view path;
+	if (element["path"].get(path) != SUCCESS) {
+		g_framesWithoutPath++;
+		return;
+	}
 
-			stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
-			gfx->Draw(g_gsButtonGreen[btn_switch], x + x_offset, group_y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+	if (path == "/devices/0/Name" || path == "/devices/0/Name/") {
+		onNetworkProbeAnswer();
+	}
 
-			sz = gfx->GetTextBlockSize(g_fntChannelBtn, "1", GFX_CENTER);
-			gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2, group_y + (g_channel_btn_size - sz.getY()) / 2, "1", GFX_CENTER);
+	PathMatch match;
+	UARouteHandler handler = g_routes.match(path, match);
+	if (handler) {
+		handler(match, element);
+	}
+}
 
-			//GROUP2
-			btn_switch = 0;
-			if (this->fader_group == 2) {
-				btn_switch = 1;
+// All complete frames of one read, still in the receive buffer, which belongs to the receiving
+// thread until this returns. The meters go to the MeterQueue with one lock. The other frames are
+// parsed in place by one parse_many: their terminating NULs become '\n', since NUL is no JSON
+// whitespace, and meters between them are blanked out; the buffer keeps FRAME_BUFFER_PADDING
+// behind the batch. After an error of the parser, or if a frame does not hold exactly one
+// document, the rest is parsed frame by frame.
+void receiveFrames(string_view batch) {
+	thread_local vector<MeterFrame> meters;
+	thread_local vector<string_view> frames; // the other ones
+
+	meters.clear();
+	frames.clear();
+
+	const char *batchEnd = batch.data() + batch.length();
+	const char *meterRun = NULL; // meters since the last other frame
+	string_view rest = batch;
+	string_view frame;
+	while (FrameBuffer::splitBatch(rest, frame)) {
+		MeterFrame meter;
+		if (receiveFrame(frame, meter)) {
+			meters.push_back(meter);
+			if (!meterRun) {
+				meterRun = frame.data();
 			}
+			continue;
+		}
+		if (meterRun && !frames.empty()) {
+			memset((char*)meterRun, ' ', frame.data() - meterRun);
+		}
+		meterRun = NULL;
+		frames.push_back(frame);
+		if (frame.data() + frame.length() < batchEnd) {
+			((char*)frame.data())[frame.length()] = '\n';
+		}
+	}
+	if (!meters.empty()) {
+		g_meterQueue.push(meters);
+	}
+	if (frames.empty()) {
+		return;
+	}
 
-			stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
-			gfx->Draw(g_gsButtonBlue[btn_switch], x + x_offset + width / 2, group_y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+	const char *begin = frames.front().data();
+	size_t length = min((size_t)(batchEnd - begin), (size_t)(frames.back().data() + frames.back().length() + 1 - begin));
 
-			sz = gfx->GetTextBlockSize(g_fntChannelBtn, "2", GFX_CENTER);
-			gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2 + width / 2, group_y + (g_channel_btn_size - sz.getY()) / 2, "2", GFX_CENTER);
+	size_t n = 0;
+	{
+		dom::document_stream stream; // done before the parser is used again below
+		if (getFrameParser().parse_many((const uint8_t*)begin, length, max(length, dom::MINIMAL_BATCH_SIZE)).get(stream) == SUCCESS) {
+			for (dom::document_stream::iterator it = stream.begin(); it != stream.end() && n < frames.size(); ++it) {
+				dom::element element;
+				if ((*it).get(element) != SUCCESS || it.current_index() != (size_t)(frames[n].data() - begin)) {
+					break;
+				}
+				dispatchFrame(element);
+				n++;
+			}
 		}
+	}
 
-		//FADER
-		//rail
-		height -= g_channel_btn_size + sz.getY() + SPACE_Y; //Fader group unterhalb
-		g_faderrail_height = height - g_fadertracker_height;
-		if (this->type == MASTER) {
-			float shorten = (float)g_faderrail_height - (float)(toMeterScale(fromDbFS(0)) * g_faderrail_height);
-			stretch = Vector2D(g_faderrail_width, g_faderrail_height - shorten);
-			gfx->Draw(g_gsFaderrail, x + (width - g_faderrail_width) / 2.0f, y + g_fadertracker_height / 2.0f + shorten,
-				NULL, GFX_NONE, 1.0f, 0, NULL, &stretch);
+	for (; n < frames.size(); n++) {
+		dom::element element;
+		if (parseFrame(frames[n]).get(element) != SUCCESS) {
+			g_framesInvalidJson++;
+			continue;
 		}
-		else {
-			stretch = Vector2D(g_faderrail_width, g_faderrail_height);
-			gfx->Draw(g_gsFaderrail, x + (width - g_faderrail_width) / 2.0f, y + g_fadertracker_height / 2.0f,
-				NULL, GFX_NONE, 1.0f, 0, NULL, &stretch);
+		dispatchFrame(element);
+	}
+}
+
+void tcpClientProc(int msg, string_view data)
+{
+	switch (msg)
+	{
+	case MSG_CLIENT_CONNECTED:
+		break;
+	case MSG_CLIENT_DISCONNECTED:
+		break;
+	case MSG_CLIENT_CONNECTION_LOST:
+	{
+		// try to reconnect
+		if (g_settings.reconnect_time && g_timer_network_reconnect == 0) {
+			g_timer_network_reconnect = SDL_AddTimer(g_settings.reconnect_time, timerCallbackReconnect, NULL);
 		}
 
-		float o = g_fadertracker_height / 2.0f;
+		//send message disconnect, the model is kept for the reconnect
+		pushEvent(EVENT_DISCONNECT, (void*)(intptr_t)true);
+		break;
+	}
+	case MSG_TEXT:
+	{
+		g_networkLastFrame.store(getNetworkTime(), memory_order_relaxed);
 
-		if (this->type != MASTER) {
-			drawScaleMark(x, y + o, 12, g_faderrail_height);
-			drawScaleMark(x, y + o, 6, g_faderrail_height);
+		MeterFrame meter;
+		if (receiveFrame(data, meter)) {
+			g_meterQueue.push(meter);
+			break;
 		}
-		drawScaleMark(x, y + o, 0, g_faderrail_height);
-		drawScaleMark(x, y + o, -6, g_faderrail_height);
-		drawScaleMark(x, y + o, -12, g_faderrail_height);
-		drawScaleMark(x, y + o, -20, g_faderrail_height);
-		drawScaleMark(x, y + o, -32, g_faderrail_height);
-		drawScaleMark(x, y + o, -52, g_faderrail_height);
-		drawScaleMark(x, y + o, -84, g_faderrail_height);
 
-		//tracker
-		if (!isnan(mod->level)) {
-			stretch = Vector2D(g_fadertracker_width, g_fadertracker_height);
+		dom::element element;
+		if (parseFrame(data).get(element) != SUCCESS) {
+			g_framesInvalidJson++;
+			break;
+		}
+		dispatchFrame(element);
+		break;
+	}
+	case MSG_TEXT_BATCH:
+	{
+		g_networkLastFrame.store(getNetworkTime(), memory_order_relaxed);
+		receiveFrames(data);
+		break;
+	}
+	}
+}
+
+void tcpClientSend(const string &msg) {
+	if (g_btnSimulation && g_btnSimulation->isHighlighted()) {
+		return;
+	}
+
+	if (g_tcpClient) {
+		writeLog(LOG_INFO| LOG_EXTENDED, "UA -> " + msg);
+		if (g_recording) {
+			g_recorder.record(RECORD_SENT, msg);
+		}
+		g_tcpClient->send(msg);
+	}
+}
+
+int SDLCALL replayThread(void *param)
+{
+	ReplayStats stats;
+	if (!replayRecording(g_replayFile, g_replaySpeed, &tcpClientProc, g_replayStop, stats)) {
+		g_msg = "Replay of " + g_replayFile + " failed";
+		writeLog(LOG_ERROR, g_msg);
+		setRedrawWindow(true);
+		return 0;
+	}
+
+	double mb = (double)stats.bytes / (1024.0 * 1024.0);
+	writeLog(LOG_INFO, "Replay: " + to_string(stats.frames) + " frames, " + to_string(mb) + " MB in " + to_string(stats.seconds) + " s (recorded "
+		+ to_string(stats.recordedSeconds) + " s, " + to_string(stats.skipped) + " sent commands skipped)");
+	if (stats.seconds > 0.0) {
+		writeLog(LOG_INFO, "Replay: " + to_string((uint64_t)((double)stats.frames / stats.seconds)) + " frames/s, " + to_string(mb / stats.seconds) + " MB/s");
+	}
+	return 0;
+}
+
+// feeds a recording to tcpClientProc instead of connecting, the main loop builds the model as usual
+void startReplay() {
+	writeLog(LOG_INFO, "Replay " + g_replayFile + (g_replaySpeed > 0.0 ? " at " + to_string(g_replaySpeed) + "x" : " as fast as possible"));
+
+	g_ua_server_connected = "replay";
+	setLoadingState(true);
+	g_btnSelectChannels->setEnable(true);
+	g_btnReorderChannels->setEnable(true);
+	g_btnChannelWidth->setEnable(true);
+	g_btnMix->setEnable(true);
+	g_selectedMixBus = "MIX";
+	g_btnMuteAll->setEnable(true);
+
+	g_replayStop = false;
+	if (!startNetworkThread(replayThread, "replayThread", NULL)) {
+		writeLog(LOG_ERROR, "Replay: Error on creating thread");
+	}
+}
+
+void tcpClientLogSendStats() { // logs what the sender thread wrote since the last call
+	if (g_tcpClient && g_settings.extended_logging) {
+		TCPSendStats stats = g_tcpClient->getSendStats();
+
+		if (stats.syscalls != g_sendStatsLogged.syscalls || stats.dropped != g_sendStatsLogged.dropped) {
+			writeLog(LOG_INFO | LOG_EXTENDED, "UA -> sent " + to_string(stats.messages - g_sendStatsLogged.messages) + " messages, "
+				+ to_string(stats.bytes - g_sendStatsLogged.bytes) + " bytes in " + to_string(stats.syscalls - g_sendStatsLogged.syscalls) + " syscalls ("
+				+ to_string(stats.coalesced - g_sendStatsLogged.coalesced) + " coalesced, " + to_string(stats.dropped - g_sendStatsLogged.dropped) + " dropped)");
+			g_sendStatsLogged = stats;
+		}
+	}
+}
+
+void tcpClientLogReceiveStats() { // logs the malformed frames received since the last call
+	size_t malformed = getMalformedFrames();
+	if (malformed != g_framesMalformedLogged && g_settings.extended_logging) {
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA <- " + to_string(malformed - g_framesMalformedLogged) + " malformed frames ("
+			+ to_string(g_framesInvalidJson.load()) + " invalid JSON, " + to_string(g_framesWithoutPath.load()) + " without path, "
+			+ to_string(g_framesInvalidData.load()) + " with unexpected data in total)");
+		g_framesMalformedLogged = malformed;
+	}
+}
+
+void drawScaleMark(float x, float y, int scale_value, double total_scale) {
+	Vector2D sz = gfx->GetTextBlockSize(g_fntFaderScale, "-1234567890");
+	double v = fromDbFS((double)scale_value);
+	y = y - (float)(toMeterScale(v) * total_scale) + (float)total_scale;
+
+	gfx->DrawShape(GFX_RECTANGLE, RGB(170, 170, 170), x + g_channel_width * 0.25f, y, g_channel_width * 0.1f, 1.0f, GFX_NONE, 0.8f);
+	gfx->Write(g_fntFaderScale, x + g_channel_width * 0.24f, y - sz.getY() * 0.5f, to_string(scale_value), GFX_RIGHT, NULL, GFX_NONE, 0.8f);
+}
+
+Module* Channel::getModule(const string &mixBus) {
+	if (mixBus == "MIX") {
+		return (Module*)this;
+	}
+	else {
+		return this->getSendByName(mixBus);
+	}
+	return NULL;
+}
+
+void Channel::draw(float _x, float _y, float _width, float _height) {
+
+	float x = _x;
+	float y = _y;
+	float width = _width;
+	float height = _height;
+
+	float SPACE_X = 2.0f;
+	float SPACE_Y = 2.0f;
+
+	Vector2D sz;
+	Vector2D stretch;
+
+	Module* mod = this->getModule(g_selectedMixBus);
+	string name = this->getName();
+
+	if (this->type == AUX) {
+		if (name == "AUX 1") {
+			name = g_settings.label_aux1;
+			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux1 == "AUX") {
+				name += " 1";
+			}
+		}
+		else if (name == "AUX 2") {
+			name = g_settings.label_aux2;
+			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux2 == "AUX") {
+				name += " 2";
+			}
+		}
+	}
+
+	bool gray = false;
+	bool highlight = false;
+
+	bool btn_select = g_btnSelectChannels->isHighlighted();
+
+	//SELECT CHANNELS
+	if (btn_select) {
+		if (!this->selected_to_show) {
+			gray = true;
+		}
+		else {
+			highlight = true;
+		}
+	}
+
+	if(highlight) {
+		unsigned int clr = RGB(200, 200, 50);
+
+		Vector2D pt = {_x - 1, _y};
+		Channel *prev_channel = getChannelByPosition(pt);
+		if (!prev_channel || !prev_channel->selected_to_show) {
+			gfx->DrawShape(GFX_RECTANGLE, clr, _x - SPACE_X, 0, SPACE_X, _height * 1.02f, GFX_NONE, 0.5f); // links
+		}
+
+		gfx->DrawShape(GFX_RECTANGLE, clr, _x, 0, _width - SPACE_X, SPACE_Y, GFX_NONE, 0.5f); // oben
+		gfx->DrawShape(GFX_RECTANGLE, clr, _x, _height * 1.02f - SPACE_Y, _width - SPACE_X, SPACE_Y, GFX_NONE, 0.5f); // unten
+		gfx->DrawShape(GFX_RECTANGLE, clr, _x + _width - SPACE_X, 0, SPACE_X, _height * 1.02f, GFX_NONE, 0.5f); // rechts
+	}
+
+	GFXSurface *gsLabel = NULL, *gsFader = NULL;
+	this->getColoredGfx(&gsLabel, &gsFader);
+
+	if (mod) {
+		//LABEL überspringen und am Ende zeichenen (wg. asugrauen)
+		y += g_fader_label_height;
+		height -= g_fader_label_height;
+
+		if (this->type == INPUT) {
+			//PAN
+			//tracker
+			if (g_btnMix->isHighlighted() || !this->stereo) {
+				float pan_width = width;
+				if (this->stereo) {
+					pan_width /= 2;
+					float local_PAN_TRACKER_HEIGHT = pan_width;
+					if (local_PAN_TRACKER_HEIGHT > g_pantracker_height)
+						local_PAN_TRACKER_HEIGHT = g_pantracker_height;
+
+					stretch = Vector2D(local_PAN_TRACKER_HEIGHT, local_PAN_TRACKER_HEIGHT);
+					gfx->Draw(g_gsPan, x + pan_width + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
+						GFX_NONE, 1.0f, 0, NULL, &stretch);
+
+					gfx->Draw(g_gsPanPointer, x + pan_width + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
+						GFX_NONE, 1.0f, DEG2RAD((float)mod->pan2 * 140.0f), NULL, &stretch);
+
+					gfx->Draw(g_gsPan, x + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
+						GFX_NONE, 1.0f, 0, NULL, &stretch);
+
+					gfx->Draw(g_gsPanPointer, x + (pan_width - local_PAN_TRACKER_HEIGHT) / 2.0f, y + (g_channel_pan_height - local_PAN_TRACKER_HEIGHT) / 2.0f, NULL,
+						GFX_NONE, 1.0f, DEG2RAD((float)mod->pan * 140.0f), NULL, &stretch);
+				}
+				else {
+					stretch = Vector2D(g_pantracker_height, g_pantracker_height);
+					gfx->Draw(g_gsPan, x + (pan_width - g_pantracker_height) / 2.0f, y + (g_channel_pan_height - g_pantracker_height) / 2.0f, NULL,
+						GFX_NONE, 1.0f, 0, NULL, &stretch);
+
+					gfx->Draw(g_gsPanPointer, x + (pan_width - g_pantracker_height) / 2.0f, y + (g_channel_pan_height - g_pantracker_height) / 2.0f, NULL,
+						GFX_NONE, 1.0f, DEG2RAD((float)mod->pan * 140.0f), NULL, &stretch);
+				}
+
+			}
+		}
+
+		gfx->SetColor(g_fntMain, RGB(20, 20, 20));
+		gfx->SetColor(g_fntFaderScale, RGB(170, 170, 170));
+		gfx->SetColor(g_fntChannelBtn, RGB(80, 80, 80));
+
+		y += g_channel_pan_height;
+		height -= g_channel_pan_height;
+
+		float x_offset = (width / 2.0f - g_channel_btn_size) / 2.0f;
+		//SOLO
+		if (g_btnMix->isHighlighted()) {
+			int btn_switch = 0;
+			if ((this->type == AUX && !this->post_fader) || (this->type != AUX && this->solo)) {
+				btn_switch = 1;
+			}
+
+			GFXSurface* gsBtn = g_gsButtonRed[btn_switch];
+			string txt = "S";
+			if (this->type == AUX) {
+				gsBtn = g_gsButtonBlue[btn_switch];
+				txt = "PRE";
+			}
+
+			if (this->type != MASTER) {
+				stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
+				gfx->Draw(gsBtn, x + x_offset, y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+
+				sz = gfx->GetTextBlockSize(g_fntChannelBtn, txt, GFX_CENTER);
+				gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2, y + (g_channel_btn_size - sz.getY()) / 2, txt, GFX_CENTER);
+			}
+		}
+
+		//MUTE
+		int btn_switch = 0;
+		if (mod->mute) {
+			btn_switch = 1;
+		}
+
+		stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
+		gfx->Draw(g_gsButtonYellow[btn_switch], x + x_offset + width / 2, y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+
+		sz = gfx->GetTextBlockSize(g_fntChannelBtn, "M", GFX_CENTER);
+		gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2 + width / 2, y + (g_channel_btn_size - sz.getY()) / 2, "M", GFX_CENTER);
+
+		y += g_channel_btn_size;
+		height -= g_channel_btn_size;
+
+		if (this->type != MASTER) {
+			//GROUPLABEL
+			float group_y = _height - g_channel_btn_size;
+			sz = gfx->GetTextBlockSize(g_fntFaderScale, "Group");
+			gfx->Write(g_fntFaderScale, x + g_channel_width / 2.0f, group_y - sz.getY() - SPACE_Y * 2.0f, "Group", GFX_CENTER, NULL, GFX_NONE, 0.9f);
+
+			//GROUP1
+			btn_switch = 0;
+			if (this->fader_group == 1) {
+				btn_switch = 1;
+			}
+
+			stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
+			gfx->Draw(g_gsButtonGreen[btn_switch], x + x_offset, group_y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+
+			sz = gfx->GetTextBlockSize(g_fntChannelBtn, "1", GFX_CENTER);
+			gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2, group_y + (g_channel_btn_size - sz.getY()) / 2, "1", GFX_CENTER);
+
+			//GROUP2
+			btn_switch = 0;
+			if (this->fader_group == 2) {
+				btn_switch = 1;
+			}
+
+			stretch = Vector2D(g_channel_btn_size, g_channel_btn_size);
+			gfx->Draw(g_gsButtonBlue[btn_switch], x + x_offset + width / 2, group_y, NULL, GFX_NONE, 1.0, 0, NULL, &stretch);
+
+			sz = gfx->GetTextBlockSize(g_fntChannelBtn, "2", GFX_CENTER);
+			gfx->Write(g_fntChannelBtn, x + x_offset + g_channel_btn_size / 2 + width / 2, group_y + (g_channel_btn_size - sz.getY()) / 2, "2", GFX_CENTER);
+		}
+
+		//FADER
+		//rail
+		height -= g_channel_btn_size + sz.getY() + SPACE_Y; //Fader group unterhalb
+		g_faderrail_height = height - g_fadertracker_height;
+		if (this->type == MASTER) {
+			float shorten = (float)g_faderrail_height - (float)(toMeterScale(fromDbFS(0)) * g_faderrail_height);
+			stretch = Vector2D(g_faderrail_width, g_faderrail_height - shorten);
+			gfx->Draw(g_gsFaderrail, x + (width - g_faderrail_width) / 2.0f, y + g_fadertracker_height / 2.0f + shorten,
+				NULL, GFX_NONE, 1.0f, 0, NULL, &stretch);
+		}
+		else {
+			stretch = Vector2D(g_faderrail_width, g_faderrail_height);
+			gfx->Draw(g_gsFaderrail, x + (width - g_faderrail_width) / 2.0f, y + g_fadertracker_height / 2.0f,
+				NULL, GFX_NONE, 1.0f, 0, NULL, &stretch);
+		}
+
+		float o = g_fadertracker_height / 2.0f;
+
+		if (this->type != MASTER) {
+			drawScaleMark(x, y + o, 12, g_faderrail_height);
+			drawScaleMark(x, y + o, 6, g_faderrail_height);
+		}
+		drawScaleMark(x, y + o, 0, g_faderrail_height);
+		drawScaleMark(x, y + o, -6, g_faderrail_height);
+		drawScaleMark(x, y + o, -12, g_faderrail_height);
+		drawScaleMark(x, y + o, -20, g_faderrail_height);
+		drawScaleMark(x, y + o, -32, g_faderrail_height);
+		drawScaleMark(x, y + o, -52, g_faderrail_height);
+		drawScaleMark(x, y + o, -84, g_faderrail_height);
+
+		//tracker
+		if (!isnan(mod->level)) {
+			stretch = Vector2D(g_fadertracker_width, g_fadertracker_height);
+
+			gfx->Draw(gsFader, x + (width - g_fadertracker_width) / 2.0f,
+				y + height - (float)toMeterScale(mod->level) * (height - g_fadertracker_height) - g_fadertracker_height, NULL,
+				GFX_NONE, 1.0f, 0, NULL, &stretch);
+		}
+
+		//Clip LED
+		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f - 1.0f,
+			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 10.0f,
+			7.0f, 9.0f);
+
+		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f,
+			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 8.0f,
+			5.0f, 7.0f);
+
+		if (mod->clip) {
+			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_RED, x + g_channel_width * 0.75f + 1,
+				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 7.0f,
+				3.0f, 5.0f);
+		}
+
+		if (this->stereo) {
+			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f + 5.0f,
+				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 10.0f,
+				7.0f, 9.0f);
+
+			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f + 6.0f,
+				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 8.0f,
+				5.0f, 7.0f);
+
+			if (mod->clip2) {
+				gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_RED, x + g_channel_width * 0.75f + 7.0f,
+					y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 7.0f,
+					3.0f, 5.0f);
+			}
+		}
+
+		//LEVELMETER
+		float threshold = g_faderrail_height * (float)toMeterScale(fromDbFS(METER_THRESHOLD));
+
+		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f - 1.0f,
+			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 1.0f,
+			7.0f, g_faderrail_height * (float)toMeterScale(UNITY) + 2.0f - threshold);
+
+		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f,
+			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height,
+			5.0f, g_faderrail_height * (float)toMeterScale(UNITY) - threshold);
+
+		if (mod->meter_level > fromDbFS(METER_THRESHOLD)) {
+			float amplitude = round(g_faderrail_height * (float)toMeterScale(mod->meter_level));
+
+			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_GREEN, x + g_channel_width * 0.75f + 1.0f,
+				y + o + g_faderrail_height - amplitude,
+				3.0f, amplitude - threshold);
+
+			if (mod->meter_level > fromDbFS(-9.0)) {
+				gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_YELLOW, x + g_channel_width * 0.75f + 1.0f,
+					y + o + g_faderrail_height - amplitude,
+					3.0f, amplitude - g_faderrail_height * (float)toMeterScale(fromDbFS(-9.0)));
+			}
+		}
+
+		if (this->stereo) {
+
+			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f + 5.0f,
+				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 1.0f,
+				7.0f, g_faderrail_height* (float)toMeterScale(UNITY) + 2.0f - threshold);
+
+			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f + 6.0f,
+				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height,
+				5.0f, g_faderrail_height* (float)toMeterScale(UNITY) - threshold);
+
+			if (mod->meter_level > fromDbFS(METER_THRESHOLD)) {
+				float amplitude = round(g_faderrail_height * (float)toMeterScale(mod->meter_level2));
+
+				gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_GREEN, x + g_channel_width * 0.75f + 7.0f,
+					y + o + g_faderrail_height - amplitude,
+					3.0f, amplitude - threshold);
+
+				if (mod->meter_level2 > fromDbFS(-9.0)) {
+					gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_YELLOW, x + g_channel_width * 0.75f + 7.0f,
+						y + o + g_faderrail_height - amplitude,
+						3.0f, amplitude - g_faderrail_height * (float)toMeterScale(fromDbFS(-9.0)));
+				}
+			}
+		}
+
+		if (gray) {
+			gfx->DrawShape(GFX_RECTANGLE, RGB(20, 20, 20), _x, 0, _width, _height * 1.02f, GFX_NONE, 0.7f);
+		}
+
+		//selektion gesperrt (serverseitig überschrieben)
+		if (btn_select && (this->isOverriddenHide() || this->isOverriddenShow())) {
+			gfx->DrawShape(GFX_RECTANGLE, RGB(255, 0, 0), _x, 0, _width, _height * 1.02f, GFX_NONE, 0.1f);
+
+			gfx->SetColor(g_fntMain, WHITE);
+			gfx->SetShadow(g_fntMain, BLACK, 1);
+			sz = gfx->GetTextBlockSize(g_fntMain, "locked", GFX_CENTER);
+			gfx->Write(g_fntMain, _x + _width / 2.0f, 0 + (_height - sz.getY()) / 2.0f, "locked", GFX_CENTER);
+			gfx->SetShadow(g_fntMain, 0, 0);
+		}
+	}
+
+	//LABEL
+	stretch = Vector2D(_width * 1.1f, g_fader_label_height);
+	gfx->Draw(gsLabel, _x - _width * 0.05f, _y, NULL, GFX_NONE, 1.0f, this->label_rotation, NULL, &stretch);
+
+	Vector2D max_size = Vector2D(_width , g_fader_label_height);
+
+	if (gsLabel == g_gsLabelBlack[this->label_gfx]) {
+		gfx->SetColor(g_fntLabel, WHITE);
+	}
+	else {
+		gfx->SetColor(g_fntLabel, BLACK);
+	}
+
+	gfx->Write(g_fntLabel, _x, _y + (g_fader_label_height - g_channel_label_fontsize) / 2.5f, shortenString(name, g_fntLabel, _width), GFX_CENTER, &max_size);
+}
+
+string shortenString(string s, GFXFont *fnt, float width) {
+
+	//split lines
+	vector<string> lines;
+	size_t front = 0;
+	size_t end;
+	do {
+		end = s.find_first_of('\n', front);
+		if (end == string::npos) {
+			lines.push_back(s.substr(front));
+		}
+		else {
+			end++;
+			lines.push_back(s.substr(front, end));
+			front = end;
+		}
+
+	} while (end != string::npos);
+
+	s = "";
+	for (auto it = lines.begin(); it != lines.end(); ++it) {
+		// remove spaces if (*it) too long
+		Vector2D sz;
+		size_t n = (*it).length() - 1;
+		do {
+			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
+			if (sz.getX() > width && isspace((*it)[n])) {
+				(*it) = (*it).substr(0, n) + (*it).substr(n + 1, (*it).length() - n + 1);
+			}
+			n--;
+		} while (sz.getX() > width && n > 0);
+
+		// remove punctuation
+		n = (*it).length() - 1;
+		do {
+			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
+			if (sz.getX() > width && ispunct((*it)[n])) {
+				(*it) = (*it).substr(0, n) + (*it).substr(n + 1, (*it).length() - n + 1);
+			}
+			n--;
+		} while (sz.getX() > width && n > 0);
+
+		// remove vowels if (*it) too long
+		n = (*it).length() - 1;
+		do {
+			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
+			if (sz.getX() > width &&
+				((*it)[n] == 'a' || (*it)[n] == 'e' || (*it)[n] == 'i' || (*it)[n] == 'o' || (*it)[n] == 'u'
+					|| (*it)[n] == 'A' || (*it)[n] == 'E' || (*it)[n] == 'I' || (*it)[n] == 'O' || (*it)[n] == 'U')) {
+				(*it) = (*it).substr(0, n) + (*it).substr(n + 1, (*it).length() - n + 1);
+			}
+			n--;
+		} while (sz.getX() > width && n > 0);
+
+		// if (*it) still too long remove chars from the end
+		do {
+			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
+			if (sz.getX() > width) {
+				(*it) = (*it).substr(0, (*it).length() - 1);
+			}
+		} while (sz.getX() > width);
+
+		s += (*it);
+	}
+	return s;
+}
+
+int getMiddleSelectedChannel() {
+
+	int index = 0;
+	int counter = 0;
+
+	for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
+		if (!it->second->isVisible(!g_btnSelectChannels->isHighlighted())) {
+			continue;
+		}
+
+		if (counter >= g_page * g_channels_per_page + g_channels_per_page / 2) {
+			break;
+		}
+		counter++;
+		if (it->second->isVisible(true)) {
+			index++;
+		}
+	}
+	return index;
+}
+
+void browseToSelectedChannel(int index) {
+
+	if (g_btnSelectChannels->isHighlighted()) {
+		int i = index;
+		for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
+			if (i <= 0) {
+				break;
+			}
+			if (it->second->isVisible(true)) {
+				i--;
+			}
+			else if (it->second->isVisible(false)) {
+				index++;
+			}
+		}
+	}
+	if (index == getActiveChannelsCount(false) + 1) {
+		g_page = 0;
+	}
+	else if (g_channels_per_page) {
+		g_page = index / g_channels_per_page;
+	}
+}
+
+void draw() {
+	
+	int w, h;
+	SDL_GetWindowSize(g_window, &w, &h);
+	float win_width = (float)w;
+	float win_height = (float)h;
+	Vector2D sz;
+	Vector2D stretch;
+
+	//background
+	gfx->DrawShape(GFX_RECTANGLE, BLACK, 0, 0, win_width, win_height);
+
+	if (g_ua_server_connected.empty() && !g_btnSimulation->isHighlighted()) { //offline
+		sz = gfx->GetTextBlockSize(g_fntOffline, "Offline");
+		gfx->SetColor(g_fntOffline, RGB(100, 100, 100));
+		gfx->Write(g_fntOffline, win_width / 2, (win_height - sz.getY()) / 2, "Offline", GFX_CENTER);
+
+		string refresh_txt = ".refreshing serverlist.";
+		if (g_serverScanTotal) {
+			refresh_txt = ".refreshing serverlist " + to_string(min(g_serverScanProbed * 100 / g_serverScanTotal, 100u)) + "%.";
+		}
+		unsigned long long time = GetTickCount64() / 1000;
+
+		for (int n = 0; n < (int)(time % 4); n++)
+			refresh_txt = "." + refresh_txt + ".";
+
+		gfx->SetColor(g_fntMain, RGB(180, 180, 180));
+		if (!g_serverlist_defined) {
+			if (g_refreshingServerList)
+				gfx->Write(g_fntMain, win_width / 2, (win_height + sz.getY()) / 2, refresh_txt, GFX_CENTER);
+			else {
+				string text = (g_btnConnect.empty() ? "No servers found\n" : "");
+				text += "Click to refresh the serverlist";
+				
+				if (g_btnConnect.empty()) {
+					text += "\nor start the simulation";
+				}
+
+				gfx->Write(g_fntMain, win_width / 2, (win_height + sz.getY()) / 2, text, GFX_CENTER);
+			}
+		}
+	}
+
+	//bg right
+	stretch = Vector2D(g_channel_offset_x, win_height);
+	gfx->Draw(g_gsBgRight, g_channel_offset_x + g_channel_width * (float)g_channels_per_page, 0, NULL,
+		GFX_NONE, 1.0, 0, NULL, &stretch);
+
+	//bg left
+	stretch = Vector2D(g_channel_offset_x, win_height);
+	gfx->Draw(g_gsBgRight, 0, 0, NULL, GFX_HFLIP, 1.0, 0, NULL, &stretch);
+
+	//draw buttons
+	g_btnMuteAll->draw(BTN_COLOR_RED);
+	for (vector<pair<string, Button*>>::iterator it = g_btnSends.begin(); it != g_btnSends.end(); ++it) {
+		if (it->second->getText() == "AUX 1") {
+			string text = g_settings.label_aux1;
+			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux1 == "AUX") {
+				text += " 1";
+			}
+			text += "\nSend";
+			it->second->draw(BTN_COLOR_BLUE, text);
+		}
+		else if (it->second->getText() == "AUX 2") {
+			string text = g_settings.label_aux2;
+			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux2 == "AUX") {
+				text += " 2";
+			}
+			text += "\nSend";
+			it->second->draw(BTN_COLOR_BLUE, text);
+		}
+		else {
+			it->second->draw(BTN_COLOR_BLUE);
+		}
+	}
+	g_btnMix->draw(BTN_COLOR_BLUE);
+
+	for (size_t n = 0; n < g_btnConnect.size(); n++) {
+		g_btnConnect[n]->draw(BTN_COLOR_GREEN);
+	}
+	g_btnSimulation->draw(BTN_COLOR_GREEN);
+	g_btnChannelWidth->draw(BTN_COLOR_YELLOW);
+	g_btnPageLeft->draw(BTN_COLOR_YELLOW);
+	g_btnPageRight->draw(BTN_COLOR_YELLOW);
+	g_btnSelectChannels->draw(BTN_COLOR_YELLOW);
+	g_btnReorderChannels->draw(BTN_COLOR_YELLOW);
+
+	float SPACE_X = 2.0f;
+	float SPACE_Y = 2.0f;
+
+	string str_page = "Page: " + to_string(g_page +1);
+
+	gfx->SetColor(g_fntMain, RGB(200, 200, 200));
+	gfx->Write(g_fntMain, g_btnPageLeft->getX() + g_btnPageLeft->getWidth() / 2,
+		g_btnPageLeft->getY() - SPACE_Y * 2.0f - g_main_fontsize, str_page, GFX_CENTER);
+
+	if(!g_ua_server_connected.empty() || g_btnSimulation->isHighlighted()) { // online
+		int count = 0;
+		int offset = 0;
+		bool btn_select = g_btnSelectChannels->isHighlighted();
+		
+		//BG
+		stretch = Vector2D(g_channel_width * (float)g_channels_per_page, win_height);
+		gfx->Draw(g_gsChannelBg, g_channel_offset_x, 0, NULL, 
+			GFX_NONE, 1.0, 0, NULL, &stretch);
+
+		Channel* reorderChannel = NULL;
+		for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
+			if (!it->second->isVisible(!btn_select))
+				continue;
+
+
+			if (it->second->touch_point.action == TOUCH_ACTION_REORDER) {
+				reorderChannel = it->second;
+			}
+			if (count >= g_page * g_channels_per_page && count < (g_page + 1) * g_channels_per_page) {
+				float x = g_channel_offset_x + (float)offset * g_channel_width;
+
+				//channel seperator
+				gfx->DrawShape(GFX_RECTANGLE, BLACK, x + g_channel_width - SPACE_X / 2.0f, 0, SPACE_X, win_height, GFX_NONE, 0.7f);
+
+				if (it->second->touch_point.action != TOUCH_ACTION_REORDER) {
+					it->second->draw(x, g_channel_offset_y, g_channel_width, g_channel_height);
+				}
+
+				offset++;
+			}
+			count++;
+		}
+
+		if (reorderChannel) {
+			float offset = reorderChannel->touch_point.pt_start_x - g_channel_offset_x;
+			offset = -fmodf(offset, g_channel_width);
+			float x = reorderChannel->touch_point.pt_end_x + offset;
+
+			float reorderInsertX = ceil((x - g_channel_offset_x) / g_channel_width) * g_channel_width + g_channel_offset_x;
+			reorderInsertX = max(reorderInsertX, g_channel_offset_x);
+			reorderInsertX = min(reorderInsertX, g_channel_offset_x + g_channel_width * (float)g_channels_per_page);
+			if (g_page == maxPages(!g_btnSelectChannels->isHighlighted())) {
+				int channelsOnLastPage = getActiveChannelsCount(true) % g_channels_per_page;
+				if (channelsOnLastPage) {
+					reorderInsertX = min(reorderInsertX, g_channel_offset_x + g_channel_width * (float)channelsOnLastPage);
+				}
+			}
+			gfx->DrawShape(GFX_RECTANGLE, RGB(200, 200, 50), reorderInsertX - 4.0f, 0, 8.0f, win_height, GFX_NONE, 0.5f);
+
+			gfx->DrawShape(GFX_RECTANGLE, BLACK, x, 0, g_channel_width, win_height, GFX_NONE, 0.5f);
+			reorderChannel->draw(x, g_channel_offset_y, g_channel_width, g_channel_height);
+		}
+	}
+
+	if (g_msg.length()) {
+		sz = gfx->GetTextBlockSize(g_fntInfo, g_msg);
+		gfx->SetColor(g_fntInfo, WHITE);
+		gfx->SetShadow(g_fntInfo, BLACK, 1.0);
+
+		gfx->DrawShape(GFX_RECTANGLE, WHITE, (win_width - sz.getX() - 20.0f) / 2.0f, (win_height - sz.getY() - 20.0f) / 2.0f, 
+			sz.getX() + 20.0f, sz.getY() + 20.0f, 0, 0.2f);
+		gfx->DrawShape(GFX_RECTANGLE, BLACK, (win_width - sz.getX() - 16.0f) / 2.0f, (win_height - sz.getY() - 16.0f) / 2.0f, 
+			sz.getX() + 16.0f, sz.getY() + 16.0f, 0, 0.7f);
+
+		gfx->Write(g_fntInfo, win_width / 2, (win_height - sz.getY()) / 2, g_msg, GFX_CENTER);
+		gfx->SetShadow(g_fntInfo, BLACK, 0);
+		gfx->SetColor(g_fntInfo, BLACK);
+	}
+
+	if (g_btnSettings->isHighlighted()) {
+
+		gfx->DrawShape(GFX_RECTANGLE, BLACK, 0, 0, win_width, win_height, 0, 0.7f);
+
+		gfx->DrawShape(GFX_RECTANGLE, WHITE, g_channel_offset_x, 0, g_settingsDlgWidth, g_settingsDlgHeight, 0, 0.3f);
+		gfx->DrawShape(GFX_RECTANGLE, BLACK, g_channel_offset_x + 2.0f, 2.0f, g_settingsDlgWidth - 4.0f, g_settingsDlgHeight - 4.0f, 0, 0.9f);
+
+		g_btnInfo->draw(BTN_COLOR_YELLOW);
+		g_btnFullscreen->draw(BTN_COLOR_GREEN);
+		g_btnLockSettings->draw(BTN_COLOR_GREEN);
+
+		float x = g_channel_offset_x + 20.0f;
+
+		string s = "Lock to mix";
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->SetColor(g_fntMain, WHITE);
+		gfx->Write(g_fntMain, x, g_btnLockToMixMIX->getY() + g_btnLockToMixMIX->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		g_btnLockToMixMIX->draw(BTN_COLOR_GREEN);
+		for (int n = 0; n < 2; n++) {
+			g_btnLockToMixAUX[n]->draw(BTN_COLOR_GREEN);
+		}
+		for (int n = 0; n < 4; n++) {
+			g_btnLockToMixCUE[n]->draw(BTN_COLOR_GREEN);
+		}
+
+		s = "Label AUX 1";
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->SetColor(g_fntMain, WHITE);
+		gfx->Write(g_fntMain, x, g_btnLabelAUX1[0]->getY() + g_btnLabelAUX1[0]->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		for (int n = 0; n < 4; n++) {
+			g_btnLabelAUX1[n]->draw(BTN_COLOR_GREEN);
+		}
+
+		s = "Label AUX 2";
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->SetColor(g_fntMain, WHITE);
+		gfx->Write(g_fntMain, x, g_btnLabelAUX2[0]->getY() + g_btnLabelAUX2[0]->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		for (int n = 0; n < 4; n++) {
+			g_btnLabelAUX2[n]->draw(BTN_COLOR_GREEN);
+		}
+
+		s = "MIX Meter";
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->SetColor(g_fntMain, WHITE);
+		gfx->Write(g_fntMain, x, g_btnPostFaderMeter->getY() + g_btnPostFaderMeter->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		g_btnPostFaderMeter->draw(BTN_COLOR_GREEN);
+
+		s = "Offline devices";
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->SetColor(g_fntMain, WHITE);
+		gfx->Write(g_fntMain, x, g_btnShowOfflineDevices->getY() + g_btnShowOfflineDevices->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		g_btnShowOfflineDevices->draw(BTN_COLOR_GREEN);
+
+		s = "Reconnect";
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->SetColor(g_fntMain, WHITE);
+		gfx->Write(g_fntMain, x, g_btnReconnect->getY() + g_btnReconnect->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		g_btnReconnect->draw(BTN_COLOR_GREEN);
 
-			gfx->Draw(gsFader, x + (width - g_fadertracker_width) / 2.0f,
-				y + height - (float)toMeterScale(mod->level) * (height - g_fadertracker_height) - g_fadertracker_height, NULL,
-				GFX_NONE, 1.0f, 0, NULL, &stretch);
+		s = "Server list";
+		gfx->SetColor(g_fntMain, WHITE);
+		sz = gfx->GetTextBlockSize(g_fntMain, s);
+		gfx->Write(g_fntMain, x, g_btnServerlistScan->getY() + g_btnServerlistScan->getHeight() / 2 - sz.getY() / 2.0f, 
+			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
+		g_btnServerlistScan->draw(BTN_COLOR_GREEN);
+		for (vector<Button*>::iterator it = g_btnsServers.begin(); it != g_btnsServers.end(); ++it) {
+			(*it)->draw(BTN_COLOR_GREEN);
 		}
 
-		//Clip LED
-		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f - 1.0f,
-			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 10.0f,
-			7.0f, 9.0f);
+		gfx->SetColor(g_fntMain, BLACK);
+	}
+	g_btnSettings->draw(BTN_COLOR_YELLOW); // draw after settings screen
 
-		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f,
-			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 8.0f,
-			5.0f, 7.0f);
+	if (g_btnInfo->isHighlighted()) {
 
-		if (mod->clip) {
-			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_RED, x + g_channel_width * 0.75f + 1,
-				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 7.0f,
-				3.0f, 5.0f);
-		}
+		gfx->DrawShape(GFX_RECTANGLE, BLACK, 0, 0, win_width, win_height, 0, 0.7f);
 
-		if (this->stereo) {
-			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f + 5.0f,
-				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 10.0f,
-				7.0f, 9.0f);
+		sz = gfx->GetTextBlockSize(g_fntInfo, INFO_TEXT);
+		gfx->SetColor(g_fntInfo, RGB(220,220,220));
+		gfx->SetShadow(g_fntInfo, BLACK, 1.0f);
 
-			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f + 6.0f,
-				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 8.0f,
-				5.0f, 7.0f);
+		gfx->DrawShape(GFX_RECTANGLE, WHITE, (win_width - sz.getX() - 30.0f) / 2.0f, (win_height - sz.getY() - 30.0f) / 2.0f, 
+			sz.getX() + 30.0f, sz.getY() + 30.0f, 0, 0.3f);
+		gfx->DrawShape(GFX_RECTANGLE, BLACK, (win_width - sz.getX() - 26.0f) / 2.0f, (win_height - sz.getY() - 26.0f) / 2.0f, 
+			sz.getX() + 26.0f, sz.getY() + 26.0f, 0, 0.9f);
 
-			if (mod->clip2) {
-				gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_RED, x + g_channel_width * 0.75f + 7.0f,
-					y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 7.0f,
-					3.0f, 5.0f);
+		gfx->Write(g_fntInfo, win_width / 2.0f, (win_height - sz.getY()) / 2.0f, INFO_TEXT, GFX_CENTER);
+		gfx->SetShadow(g_fntInfo, BLACK, 0);
+		gfx->SetColor(g_fntInfo, BLACK);
+	}
+
+	if (g_resetOrderCountdown || g_unmuteAllCountdown || g_selectAllChannelsCountdown) {
+		string msg = "Hold for ";
+		
+		if (g_resetOrderCountdown) {
+			msg += to_string(g_resetOrderCountdown) + "s to reset channel order";
+		}
+		else if(g_unmuteAllCountdown) {
+			msg += to_string(g_unmuteAllCountdown) + "s to unmute all channels";
+			if (!g_settings.lock_to_mix.empty()) {
+				msg += " of " + g_settings.lock_to_mix;
+			}
+		}
+		else if (g_selectAllChannelsCountdown) {
+			if (g_selectAllChannelsCountdown > 4) {
+				msg += to_string(g_selectAllChannelsCountdown - 4) + "s to select all channels\n or ";
 			}
+			msg += to_string(g_selectAllChannelsCountdown) + "s to unselect all channels";
 		}
 
-		//LEVELMETER
-		float threshold = g_faderrail_height * (float)toMeterScale(fromDbFS(METER_THRESHOLD));
+		sz = gfx->GetTextBlockSize(g_fntInfo, msg);
+		gfx->SetColor(g_fntInfo, WHITE);
+		gfx->SetShadow(g_fntInfo, BLACK, 1.0);
 
-		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f - 1.0f,
-			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 1.0f,
-			7.0f, g_faderrail_height * (float)toMeterScale(UNITY) + 2.0f - threshold);
+		gfx->DrawShape(GFX_RECTANGLE, WHITE, (win_width - sz.getX() - 20.0f) / 2.0f, (win_height - sz.getY() - 20.0f) / 2.0f,
+			sz.getX() + 20.0f, sz.getY() + 20.0f, 0, 0.2f);
+		gfx->DrawShape(GFX_RECTANGLE, BLACK, (win_width - sz.getX() - 16.0f) / 2.0f, (win_height - sz.getY() - 16.0f) / 2.0f,
+			sz.getX() + 16.0f, sz.getY() + 16.0f, 0, 0.7f);
 
-		gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f,
-			y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height,
-			5.0f, g_faderrail_height * (float)toMeterScale(UNITY) - threshold);
+		gfx->Write(g_fntInfo, win_width / 2, (win_height - sz.getY()) / 2, msg, GFX_CENTER);
+		gfx->SetShadow(g_fntInfo, BLACK, 0);
+		gfx->SetColor(g_fntInfo, BLACK);
+	}
+	
+	gfx->Update();
+}
 
-		if (mod->meter_level > fromDbFS(METER_THRESHOLD)) {
-			float amplitude = round(g_faderrail_height * (float)toMeterScale(mod->meter_level));
+void setLoadingState(bool loading) {
+	g_loading = loading;
 
-			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_GREEN, x + g_channel_width * 0.75f + 1.0f,
-				y + o + g_faderrail_height - amplitude,
-				3.0f, amplitude - threshold);
+	int state = g_connectionState;
+	if (loading && state == CONNECTION_LIVE) {
+		setConnectionState(CONNECTION_LOADING);
+	}
+	else if (!loading && (state == CONNECTION_HANDSHAKING || state == CONNECTION_LOADING)) {
+		setConnectionState(CONNECTION_LIVE);
+	}
+}
 
-			if (mod->meter_level > fromDbFS(-9.0)) {
-				gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_YELLOW, x + g_channel_width * 0.75f + 1.0f,
-					y + o + g_faderrail_height - amplitude,
-					3.0f, amplitude - g_faderrail_height * (float)toMeterScale(fromDbFS(-9.0)));
-			}
-		}
+bool isLoading() {
+	return g_loading;
+}
 
-		if (this->stereo) {
+void setConnectionState(int state) { // thread safe, the main loop gets notified by EVENT_CONNECTION_STATE
+	if (g_connectionState.exchange(state) != state) {
+		pushEvent(EVENT_CONNECTION_STATE, (void*)(intptr_t)state);
+	}
+}
 
-			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BORDER, x + g_channel_width * 0.75f + 5.0f,
-				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height - 1.0f,
-				7.0f, g_faderrail_height* (float)toMeterScale(UNITY) + 2.0f - threshold);
+int getConnectionState() {
+	return g_connectionState;
+}
 
-			gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_BG, x + g_channel_width * 0.75f + 6.0f,
-				y + o - (float)toMeterScale(UNITY) * g_faderrail_height + g_faderrail_height,
-				5.0f, g_faderrail_height* (float)toMeterScale(UNITY) - threshold);
+string getConnectionStateName(int state) {
+	switch (state) {
+	case CONNECTION_OFFLINE:
+		return "offline";
+	case CONNECTION_RESOLVING:
+		return "resolving";
+	case CONNECTION_CONNECTING:
+		return "connecting";
+	case CONNECTION_HANDSHAKING:
+		return "handshaking";
+	case CONNECTION_LOADING:
+		return "loading";
+	case CONNECTION_LIVE:
+		return "live";
+	}
+	return "unknown";
+}
 
-			if (mod->meter_level > fromDbFS(METER_THRESHOLD)) {
-				float amplitude = round(g_faderrail_height * (float)toMeterScale(mod->meter_level2));
+void onConnectionStateChanged(int state) {
+	writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Connection state " + getConnectionStateName(state));
 
-				gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_GREEN, x + g_channel_width * 0.75f + 7.0f,
-					y + o + g_faderrail_height - amplitude,
-					3.0f, amplitude - threshold);
+	if (state == CONNECTION_RESOLVING || state == CONNECTION_CONNECTING || state == CONNECTION_HANDSHAKING) {
+		g_msg = "Connecting to " + g_ua_server_connecting + ":" + UA_TCP_PORT + " (" + getConnectionStateName(state) + ")";
+	}
+	else if (state == CONNECTION_LOADING || state == CONNECTION_LIVE) {
+		g_msg = "";
+	}
+	setRedrawWindow(true);
+}
 
-				if (mod->meter_level2 > fromDbFS(-9.0)) {
-					gfx->DrawShape(GFX_RECTANGLE, METER_COLOR_YELLOW, x + g_channel_width * 0.75f + 7.0f,
-						y + o + g_faderrail_height - amplitude,
-						3.0f, amplitude - g_faderrail_height * (float)toMeterScale(fromDbFS(-9.0)));
-				}
+void logConnectRace(const vector<TCPRaceResult> &results, int winner)
+{
+	for (size_t n = 0; n < results.size(); n++) {
+		string log = "UA:  Connect race " + results[n].host + ": ";
+		if (results[n].connectTime == -1) {
+			log += "no connection";
+		}
+		else {
+			log += "connected after " + to_string(results[n].connectTime) + " us";
+			if (results[n].answerTime == -1) {
+				log += ", no answer";
+			}
+			else {
+				log += ", answered after " + to_string(results[n].answerTime) + " us";
 			}
 		}
-
-		if (gray) {
-			gfx->DrawShape(GFX_RECTANGLE, RGB(20, 20, 20), _x, 0, _width, _height * 1.02f, GFX_NONE, 0.7f);
+		if ((int)n == winner) {
+			log += " (winner)";
 		}
+		writeLog(LOG_INFO | LOG_EXTENDED, log);
+	}
+}
 
-		//selektion gesperrt (serverseitig überschrieben)
-		if (btn_select && (this->isOverriddenHide() || this->isOverriddenShow())) {
-			gfx->DrawShape(GFX_RECTANGLE, RGB(255, 0, 0), _x, 0, _width, _height * 1.02f, GFX_NONE, 0.1f);
+struct StandbySkeleton {
+	vector<string> devices;
+	map<string, vector<string>> inputs; // by device id
+	vector<string> auxs;
+	vector<string> outputs;
+	int cueBusCount; // -1 until known
+	bool auxsLoaded;
+	bool outputsLoaded;
+};
 
-			gfx->SetColor(g_fntMain, WHITE);
-			gfx->SetShadow(g_fntMain, BLACK, 1);
-			sz = gfx->GetTextBlockSize(g_fntMain, "locked", GFX_CENTER);
-			gfx->Write(g_fntMain, _x + _width / 2.0f, 0 + (_height - sz.getY()) / 2.0f, "locked", GFX_CENTER);
-			gfx->SetShadow(g_fntMain, 0, 0);
+// a lightly subscribed connection to another server of the list, holding the device and channel ids
+struct StandbyConnection {
+	int generation;
+	string host;
+	TCPClient *client; // g_mutex_standby
+	bool connecting;
+	unsigned int rtt;
+	atomic<bool> promoted; // messages go to tcpClientProc
+	atomic<bool> lost;
+	StandbySkeleton skeleton; // g_mutex_standby
+};
+
+StandbyConnection g_standby[UA_MAX_SERVER_LIST];
+mutex g_mutex_standby;
+
+typedef void (*StandbyRouteHandler)(StandbyConnection &standby, const PathMatch &match, dom::element element);
+PathRouter<StandbyRouteHandler> g_standbyRoutes; // built once by initStandbyRoutes()
+
+bool isStandbyReady(const StandbySkeleton &skeleton) {
+	if (skeleton.devices.empty() || skeleton.cueBusCount < 0 || !skeleton.auxsLoaded || !skeleton.outputsLoaded) {
+		return false;
+	}
+	for (vector<string>::const_iterator it = skeleton.devices.begin(); it != skeleton.devices.end(); ++it) {
+		if (skeleton.inputs.find(*it) == skeleton.inputs.end()) {
+			return false;
 		}
 	}
+	return true;
+}
 
-	//LABEL
-	stretch = Vector2D(_width * 1.1f, g_fader_label_height);
-	gfx->Draw(gsLabel, _x - _width * 0.05f, _y, NULL, GFX_NONE, 1.0f, this->label_rotation, NULL, &stretch);
+void resetStandbySkeleton(StandbySkeleton &skeleton) {
+	skeleton.devices.clear();
+	skeleton.inputs.clear();
+	skeleton.auxs.clear();
+	skeleton.outputs.clear();
+	skeleton.cueBusCount = -1;
+	skeleton.auxsLoaded = false;
+	skeleton.outputsLoaded = false;
+}
 
-	Vector2D max_size = Vector2D(_width , g_fader_label_height);
+// route handlers of standbyProc, called with g_mutex_standby held, captures: device
 
-	if (gsLabel == g_gsLabelBlack[this->label_gfx]) {
-		gfx->SetColor(g_fntLabel, WHITE);
+void onStandbySessionChanged(StandbyConnection &standby, const PathMatch &match, dom::element element) {
+	// the skeleton is outdated
+	if (isStandbyReady(standby.skeleton)) {
+		resetStandbySkeleton(standby.skeleton);
+		standby.client->send("get /devices");
 	}
-	else {
-		gfx->SetColor(g_fntLabel, BLACK);
+}
+
+void onStandbyDevices(StandbyConnection &standby, const PathMatch &match, dom::element element) {
+	resetStandbySkeleton(standby.skeleton);
+	getChildren(element, standby.skeleton.devices);
+	if (!standby.skeleton.devices.empty()) {
+		standby.client->send("get /devices/0/CueBusCount");
+		standby.client->send("get /devices/0/auxs");
+		standby.client->send("get /devices/0/outputs");
+	}
+	for (vector<string>::iterator it = standby.skeleton.devices.begin(); it != standby.skeleton.devices.end(); ++it) {
+		standby.client->send("get /devices/" + *it + "/inputs");
 	}
+}
 
-	gfx->Write(g_fntLabel, _x, _y + (g_fader_label_height - g_channel_label_fontsize) / 2.5f, shortenString(name, g_fntLabel, _width), GFX_CENTER, &max_size);
+void onStandbyCueBusCount(StandbyConnection &standby, const PathMatch &match, dom::element element) {
+	int64_t cueBusCount;
+	if (getRouteData(element, cueBusCount)) {
+		standby.skeleton.cueBusCount = (int)cueBusCount;
+	}
 }
 
-string shortenString(string s, GFXFont *fnt, float width) {
+void onStandbyInputs(StandbyConnection &standby, const PathMatch &match, dom::element element) {
+	vector<string> inputs;
+	if (getChildren(element, inputs)) {
+		standby.skeleton.inputs[string(match.segment[0])] = inputs;
+	}
+}
 
-	//split lines
-	vector<string> lines;
-	size_t front = 0;
-	size_t end;
-	do {
-		end = s.find_first_of('\n', front);
-		if (end == string::npos) {
-			lines.push_back(s.substr(front));
-		}
-		else {
-			end++;
-			lines.push_back(s.substr(front, end));
-			front = end;
-		}
+void onStandbyAuxs(StandbyConnection &standby, const PathMatch &match, dom::element element) {
+	if (match.value[0] == 0) {
+		standby.skeleton.auxs.clear();
+		standby.skeleton.auxsLoaded = getChildren(element, standby.skeleton.auxs);
+	}
+}
 
-	} while (end != string::npos);
+void onStandbyOutputs(StandbyConnection &standby, const PathMatch &match, dom::element element) {
+	if (match.value[0] == 0) {
+		standby.skeleton.outputs.clear();
+		standby.skeleton.outputsLoaded = getChildren(element, standby.skeleton.outputs);
+	}
+}
 
-	s = "";
-	for (auto it = lines.begin(); it != lines.end(); ++it) {
-		// remove spaces if (*it) too long
-		Vector2D sz;
-		size_t n = (*it).length() - 1;
-		do {
-			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
-			if (sz.getX() > width && isspace((*it)[n])) {
-				(*it) = (*it).substr(0, n) + (*it).substr(n + 1, (*it).length() - n + 1);
-			}
-			n--;
-		} while (sz.getX() > width && n > 0);
+void initStandbyRoutes() {
+	g_standbyRoutes.add("/Session/*", onStandbySessionChanged);
+	g_standbyRoutes.add("/IOMapPreset/*", onStandbySessionChanged);
+	g_standbyRoutes.add("/devices", onStandbyDevices);
+	g_standbyRoutes.add("/devices/#/CueBusCount/*", onStandbyCueBusCount);
+	g_standbyRoutes.add("/devices/#/inputs", onStandbyInputs);
+	g_standbyRoutes.add("/devices/#/auxs", onStandbyAuxs);
+	g_standbyRoutes.add("/devices/#/outputs", onStandbyOutputs);
+}
 
-		// remove punctuation
-		n = (*it).length() - 1;
-		do {
-			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
-			if (sz.getX() > width && ispunct((*it)[n])) {
-				(*it) = (*it).substr(0, n) + (*it).substr(n + 1, (*it).length() - n + 1);
-			}
-			n--;
-		} while (sz.getX() > width && n > 0);
+template<int slot> void standbyProc(int msg, string_view data)
+{
+	StandbyConnection &standby = g_standby[slot];
 
-		// remove vowels if (*it) too long
-		n = (*it).length() - 1;
-		do {
-			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
-			if (sz.getX() > width &&
-				((*it)[n] == 'a' || (*it)[n] == 'e' || (*it)[n] == 'i' || (*it)[n] == 'o' || (*it)[n] == 'u'
-					|| (*it)[n] == 'A' || (*it)[n] == 'E' || (*it)[n] == 'I' || (*it)[n] == 'O' || (*it)[n] == 'U')) {
-				(*it) = (*it).substr(0, n) + (*it).substr(n + 1, (*it).length() - n + 1);
-			}
-			n--;
-		} while (sz.getX() > width && n > 0);
+	if (msg == MSG_CLIENT_CONNECTION_LOST) {
+		standby.lost = true;
+		pushEvent(EVENT_STANDBY_UPDATE);
+	}
+	if (standby.promoted) {
+		tcpClientProc(msg, data);
+		return;
+	}
+	if (msg == MSG_TEXT_BATCH) {
+		string_view frame;
+		while (FrameBuffer::splitBatch(data, frame)) {
+			standbyProc<slot>(MSG_TEXT, frame);
+		}
+		return;
+	}
+	if (msg != MSG_TEXT) {
+		return;
+	}
+
+	dom::element element;
+	string_view path;
+	if (parseFrame(data).get(element) != SUCCESS) {
+		g_framesInvalidJson++;
+		return;
+	}
+	if (element["path"].get(path) != SUCCESS) {
+		g_framesWithoutPath++;
+		return;
+	}
 
-		// if (*it) still too long remove chars from the end
-		do {
-			sz = gfx->GetTextBlockSize(fnt, (*it), GFX_CENTER);
-			if (sz.getX() > width) {
-				(*it) = (*it).substr(0, (*it).length() - 1);
-			}
-		} while (sz.getX() > width);
+	PathMatch match;
+	StandbyRouteHandler handler = g_standbyRoutes.match(path, match);
+	if (!handler) {
+		return;
+	}
 
-		s += (*it);
+	const std::lock_guard<std::mutex> lock(g_mutex_standby);
+	if (standby.client) {
+		handler(standby, match, element);
 	}
-	return s;
 }
 
-int getMiddleSelectedChannel() {
+static_assert(UA_MAX_SERVER_LIST == 3, "one standbyProc per connect button");
+void (*g_standbyProc[UA_MAX_SERVER_LIST])(int, string_view) = { standbyProc<0>, standbyProc<1>, standbyProc<2> };
 
-	int index = 0;
-	int counter = 0;
+struct StandbyConnectRequest {
+	int slot;
+	int generation;
+	string host;
+};
 
-	for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
-		if (!it->second->isVisible(!g_btnSelectChannels->isHighlighted())) {
-			continue;
-		}
+int SDLCALL standbyConnectThread(void *param)
+{
+	StandbyConnectRequest *request = (StandbyConnectRequest*)param;
+	StandbyConnection &standby = g_standby[request->slot];
 
-		if (counter >= g_page * g_channels_per_page + g_channels_per_page / 2) {
-			break;
-		}
-		counter++;
-		if (it->second->isVisible(true)) {
-			index++;
-		}
+	TCPClient *client = NULL;
+	unsigned int rtt = 0;
+	try {
+		string ip = TCPClient::resolveHost(request->host);
+		chrono::steady_clock::time_point connectStart = chrono::steady_clock::now();
+		client = new TCPClient(ip, UA_TCP_PORT, g_standbyProc[request->slot]);
+		rtt = (unsigned int)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - connectStart).count();
+	}
+	catch (const invalid_argument &error) {
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Standby connection to " + request->host + ":" + UA_TCP_PORT + " failed: " + error.what());
 	}
-	return index;
-}
-
-void browseToSelectedChannel(int index) {
 
-	if (g_btnSelectChannels->isHighlighted()) {
-		int i = index;
-		for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
-			if (i <= 0) {
-				break;
-			}
-			if (it->second->isVisible(true)) {
-				i--;
-			}
-			else if (it->second->isVisible(false)) {
-				index++;
-			}
+	g_mutex_standby.lock();
+	if (standby.generation != request->generation) { // given up meanwhile
+		g_mutex_standby.unlock();
+		if (client) {
+			delete client;
 		}
+		delete request;
+		return 0;
 	}
-	if (index == getActiveChannelsCount(false) + 1) {
-		g_page = 0;
+	standby.connecting = false;
+	standby.client = client;
+	standby.rtt = rtt;
+	if (client) {
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Standby connection to " + request->host + ":" + UA_TCP_PORT);
+		client->send("subscribe /Session");
+		client->send("subscribe /IOMapPreset");
+		client->send("get /devices");
 	}
-	else if (g_channels_per_page) {
-		g_page = index / g_channels_per_page;
+	else {
+		standby.lost = true; // retried on the next update
 	}
+	g_mutex_standby.unlock();
+
+	delete request;
+	return 0;
 }
 
-void draw() {
-	
-	int w, h;
-	SDL_GetWindowSize(g_window, &w, &h);
-	float win_width = (float)w;
-	float win_height = (float)h;
-	Vector2D sz;
-	Vector2D stretch;
+void closeStandbyConnection(int slot) {
+	StandbyConnection &standby = g_standby[slot];
 
-	//background
-	gfx->DrawShape(GFX_RECTANGLE, BLACK, 0, 0, win_width, win_height);
+	g_mutex_standby.lock();
+	TCPClient *client = standby.client;
+	standby.client = NULL;
+	standby.generation++;
+	standby.connecting = false;
+	standby.host = "";
+	standby.lost = false;
+	resetStandbySkeleton(standby.skeleton);
+	g_mutex_standby.unlock();
 
-	if (g_ua_server_connected.empty() && !g_btnSimulation->isHighlighted()) { //offline
-		sz = gfx->GetTextBlockSize(g_fntOffline, "Offline");
-		gfx->SetColor(g_fntOffline, RGB(100, 100, 100));
-		gfx->Write(g_fntOffline, win_width / 2, (win_height - sz.getY()) / 2, "Offline", GFX_CENTER);
+	if (client) {
+		delete client;
+	}
+}
 
-		string refresh_txt = ".refreshing serverlist.";
-		unsigned long long time = GetTickCount64() / 1000;
+Uint32 timerCallbackStandby(Uint32 interval, void* param) //g_timer_standby
+{
+	pushEvent(EVENT_STANDBY_UPDATE);
+	return interval;
+}
 
-		for (int n = 0; n < (int)(time % 4); n++)
-			refresh_txt = "." + refresh_txt + ".";
+// g_timer_standby only runs while standby connections are wanted
+void updateStandbyTimer() {
+	if (g_settings.standby_connections && g_running) {
+		if (g_timer_standby == 0) {
+			g_timer_standby = SDL_AddTimer(STANDBY_UPDATE_TIME, timerCallbackStandby, NULL);
+		}
+	}
+	else if (g_timer_standby != 0) {
+		SDL_RemoveTimer(g_timer_standby);
+		g_timer_standby = 0;
+	}
+}
 
-		gfx->SetColor(g_fntMain, RGB(180, 180, 180));
-		if (!g_serverlist_defined) {
-			if (g_refreshingServerList)
-				gfx->Write(g_fntMain, win_width / 2, (win_height + sz.getY()) / 2, refresh_txt, GFX_CENTER);
-			else {
-				string text = (g_btnConnect.empty() ? "No servers found\n" : "");
-				text += "Click to refresh the serverlist";
-				
-				if (g_btnConnect.empty()) {
-					text += "\nor start the simulation";
-				}
+// keeps a standby connection open to each server on the connect buttons, but the active one
+void updateStandbyConnections() {
+	updateStandbyTimer();
 
-				gfx->Write(g_fntMain, win_width / 2, (win_height + sz.getY()) / 2, text, GFX_CENTER);
+	vector<string> hosts;
+	if (g_settings.standby_connections && g_running) {
+		for (size_t n = 0; n < g_btnConnect.size(); n++) {
+			string host = serverListGet(g_btnConnect[n]->getId() - ID_BTN_CONNECT);
+			if (!host.empty() && host != g_ua_server_connected && host != g_ua_server_connecting) {
+				hosts.push_back(host);
 			}
 		}
 	}
 
-	//bg right
-	stretch = Vector2D(g_channel_offset_x, win_height);
-	gfx->Draw(g_gsBgRight, g_channel_offset_x + g_channel_width * (float)g_channels_per_page, 0, NULL,
-		GFX_NONE, 1.0, 0, NULL, &stretch);
-
-	//bg left
-	stretch = Vector2D(g_channel_offset_x, win_height);
-	gfx->Draw(g_gsBgRight, 0, 0, NULL, GFX_HFLIP, 1.0, 0, NULL, &stretch);
+	for (int n = 0; n < UA_MAX_SERVER_LIST; n++) {
+		StandbyConnection &standby = g_standby[n];
+		g_mutex_standby.lock();
+		string host = standby.host;
+		bool lost = standby.lost && !standby.connecting;
+		g_mutex_standby.unlock();
 
-	//draw buttons
-	g_btnMuteAll->draw(BTN_COLOR_RED);
-	for (vector<pair<string, Button*>>::iterator it = g_btnSends.begin(); it != g_btnSends.end(); ++it) {
-		if (it->second->getText() == "AUX 1") {
-			string text = g_settings.label_aux1;
-			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux1 == "AUX") {
-				text += " 1";
-			}
-			text += "\nSend";
-			it->second->draw(BTN_COLOR_BLUE, text);
+		if (standby.promoted || host.empty()) {
+			continue;
 		}
-		else if (it->second->getText() == "AUX 2") {
-			string text = g_settings.label_aux2;
-			if (g_settings.label_aux1 == g_settings.label_aux2 || g_settings.label_aux2 == "AUX") {
-				text += " 2";
-			}
-			text += "\nSend";
-			it->second->draw(BTN_COLOR_BLUE, text);
+		vector<string>::iterator it = find(hosts.begin(), hosts.end(), host);
+		if (it == hosts.end() || lost) {
+			closeStandbyConnection(n); // reopened below if still wanted
 		}
 		else {
-			it->second->draw(BTN_COLOR_BLUE);
+			hosts.erase(it);
 		}
 	}
-	g_btnMix->draw(BTN_COLOR_BLUE);
-
-	for (size_t n = 0; n < g_btnConnect.size(); n++) {
-		g_btnConnect[n]->draw(BTN_COLOR_GREEN);
-	}
-	g_btnSimulation->draw(BTN_COLOR_GREEN);
-	g_btnChannelWidth->draw(BTN_COLOR_YELLOW);
-	g_btnPageLeft->draw(BTN_COLOR_YELLOW);
-	g_btnPageRight->draw(BTN_COLOR_YELLOW);
-	g_btnSelectChannels->draw(BTN_COLOR_YELLOW);
-	g_btnReorderChannels->draw(BTN_COLOR_YELLOW);
-
-	float SPACE_X = 2.0f;
-	float SPACE_Y = 2.0f;
-
-	string str_page = "Page: " + to_string(g_page +1);
-
-	gfx->SetColor(g_fntMain, RGB(200, 200, 200));
-	gfx->Write(g_fntMain, g_btnPageLeft->getX() + g_btnPageLeft->getWidth() / 2,
-		g_btnPageLeft->getY() - SPACE_Y * 2.0f - g_main_fontsize, str_page, GFX_CENTER);
-
-	if(!g_ua_server_connected.empty() || g_btnSimulation->isHighlighted()) { // online
-		int count = 0;
-		int offset = 0;
-		bool btn_select = g_btnSelectChannels->isHighlighted();
-		
-		//BG
-		stretch = Vector2D(g_channel_width * (float)g_channels_per_page, win_height);
-		gfx->Draw(g_gsChannelBg, g_channel_offset_x, 0, NULL, 
-			GFX_NONE, 1.0, 0, NULL, &stretch);
 
-		Channel* reorderChannel = NULL;
-		for (map<int, Channel*>::iterator it = g_channelsInOrder.begin(); it != g_channelsInOrder.end(); ++it) {
-			if (!it->second->isVisible(!btn_select))
+	for (vector<string>::iterator it = hosts.begin(); it != hosts.end(); ++it) {
+		for (int n = 0; n < UA_MAX_SERVER_LIST; n++) {
+			StandbyConnection &standby = g_standby[n];
+			g_mutex_standby.lock();
+			if (standby.promoted || !standby.host.empty()) {
+				g_mutex_standby.unlock();
 				continue;
-
-
-			if (it->second->touch_point.action == TOUCH_ACTION_REORDER) {
-				reorderChannel = it->second;
 			}
-			if (count >= g_page * g_channels_per_page && count < (g_page + 1) * g_channels_per_page) {
-				float x = g_channel_offset_x + (float)offset * g_channel_width;
-
-				//channel seperator
-				gfx->DrawShape(GFX_RECTANGLE, BLACK, x + g_channel_width - SPACE_X / 2.0f, 0, SPACE_X, win_height, GFX_NONE, 0.7f);
-
-				if (it->second->touch_point.action != TOUCH_ACTION_REORDER) {
-					it->second->draw(x, g_channel_offset_y, g_channel_width, g_channel_height);
-				}
 
-				offset++;
+			StandbyConnectRequest *request = new StandbyConnectRequest;
+			standby.host = *it;
+			standby.connecting = true;
+			standby.lost = false;
+			request->slot = n;
+			request->generation = ++standby.generation;
+			request->host = *it;
+			g_mutex_standby.unlock();
+
+			if (!startNetworkThread(standbyConnectThread, "standbyConnectThread", (void*)request)) {
+				delete request;
+				closeStandbyConnection(n);
 			}
-			count++;
+			break;
 		}
+	}
+}
 
-		if (reorderChannel) {
-			float offset = reorderChannel->touch_point.pt_start_x - g_channel_offset_x;
-			offset = -fmodf(offset, g_channel_width);
-			float x = reorderChannel->touch_point.pt_end_x + offset;
-
-			float reorderInsertX = ceil((x - g_channel_offset_x) / g_channel_width) * g_channel_width + g_channel_offset_x;
-			reorderInsertX = max(reorderInsertX, g_channel_offset_x);
-			reorderInsertX = min(reorderInsertX, g_channel_offset_x + g_channel_width * (float)g_channels_per_page);
-			if (g_page == maxPages(!g_btnSelectChannels->isHighlighted())) {
-				int channelsOnLastPage = getActiveChannelsCount(true) % g_channels_per_page;
-				if (channelsOnLastPage) {
-					reorderInsertX = min(reorderInsertX, g_channel_offset_x + g_channel_width * (float)channelsOnLastPage);
-				}
-			}
-			gfx->DrawShape(GFX_RECTANGLE, RGB(200, 200, 50), reorderInsertX - 4.0f, 0, 8.0f, win_height, GFX_NONE, 0.5f);
+void closeStandbyConnections() {
+	for (int n = 0; n < UA_MAX_SERVER_LIST; n++) {
+		g_standby[n].promoted = false;
+		closeStandbyConnection(n);
+	}
+}
 
-			gfx->DrawShape(GFX_RECTANGLE, BLACK, x, 0, g_channel_width, win_height, GFX_NONE, 0.5f);
-			reorderChannel->draw(x, g_channel_offset_y, g_channel_width, g_channel_height);
+int getStandbySlot(TCPClient *client) {
+	const std::lock_guard<std::mutex> lock(g_mutex_standby);
+	for (int n = 0; n < UA_MAX_SERVER_LIST; n++) {
+		if (client && g_standby[n].client == client) {
+			return n;
 		}
 	}
+	return -1;
+}
 
-	if (g_msg.length()) {
-		sz = gfx->GetTextBlockSize(g_fntInfo, g_msg);
-		gfx->SetColor(g_fntInfo, WHITE);
-		gfx->SetShadow(g_fntInfo, BLACK, 1.0);
+struct ConnectRequest {
+	int generation;
+	int connection_index;
+	string host;
+	vector<string> servers; // race candidates, empty if only host is tried
+	TCPClient *client;
+	unsigned int rtt;
+	string error;
+	StandbySkeleton *skeleton; // device and channel ids of a promoted standby connection
+};
 
-		gfx->DrawShape(GFX_RECTANGLE, WHITE, (win_width - sz.getX() - 20.0f) / 2.0f, (win_height - sz.getY() - 20.0f) / 2.0f, 
-			sz.getX() + 20.0f, sz.getY() + 20.0f, 0, 0.2f);
-		gfx->DrawShape(GFX_RECTANGLE, BLACK, (win_width - sz.getX() - 16.0f) / 2.0f, (win_height - sz.getY() - 16.0f) / 2.0f, 
-			sz.getX() + 16.0f, sz.getY() + 16.0f, 0, 0.7f);
+// hands a ready standby connection over as the active one, NULL if there is none for the host
+ConnectRequest *promoteStandby(int connection_index) {
+	string host = serverListGet(connection_index);
 
-		gfx->Write(g_fntInfo, win_width / 2, (win_height - sz.getY()) / 2, g_msg, GFX_CENTER);
-		gfx->SetShadow(g_fntInfo, BLACK, 0);
-		gfx->SetColor(g_fntInfo, BLACK);
-	}
+	const std::lock_guard<std::mutex> lock(g_mutex_standby);
+	for (int n = 0; n < UA_MAX_SERVER_LIST; n++) {
+		StandbyConnection &standby = g_standby[n];
+		if (standby.host != host || !standby.client || standby.lost || !isStandbyReady(standby.skeleton)) {
+			continue;
+		}
 
-	if (g_btnSettings->isHighlighted()) {
+		ConnectRequest *request = new ConnectRequest;
+		request->generation = ++g_connectGeneration;
+		request->connection_index = connection_index;
+		request->host = host;
+		request->client = standby.client;
+		request->rtt = standby.rtt;
+		request->skeleton = new StandbySkeleton(standby.skeleton);
+		standby.promoted = true;
+		return request;
+	}
+	return NULL;
+}
 
-		gfx->DrawShape(GFX_RECTANGLE, BLACK, 0, 0, win_width, win_height, 0, 0.7f);
+// the active connection goes back to standby, everything subscribed for the model is unsubscribed
+void demoteStandby(int slot) {
+	StandbyConnection &standby = g_standby[slot];
 
-		gfx->DrawShape(GFX_RECTANGLE, WHITE, g_channel_offset_x, 0, g_settingsDlgWidth, g_settingsDlgHeight, 0, 0.3f);
-		gfx->DrawShape(GFX_RECTANGLE, BLACK, g_channel_offset_x + 2.0f, 2.0f, g_settingsDlgWidth - 4.0f, g_settingsDlgHeight - 4.0f, 0, 0.9f);
+	if (!standby.lost) {
+		for (unordered_map<string, Channel*>::iterator it = g_channelsById.begin(); it != g_channelsById.end(); ++it) {
+			it->second->updateSubscription(false, ALL | ALL_MIXES);
+		}
+		for (vector<UADevice*>::iterator it = g_ua_devices.begin(); it != g_ua_devices.end(); ++it) {
+			tcpClientSend("unsubscribe /devices/" + (*it)->id + "/DeviceOnline/");
+		}
+		tcpClientSend("unsubscribe /devices/0/CueBusCount");
+		tcpClientSend("unsubscribe /PostFaderMetering");
+	}
 
-		g_btnInfo->draw(BTN_COLOR_YELLOW);
-		g_btnFullscreen->draw(BTN_COLOR_GREEN);
-		g_btnLockSettings->draw(BTN_COLOR_GREEN);
+	g_mutex_standby.lock();
+	standby.promoted = false;
+	resetStandbySkeleton(standby.skeleton);
+	if (standby.client && !standby.lost) {
+		standby.client->send("get /devices");
+	}
+	g_mutex_standby.unlock();
+}
 
-		float x = g_channel_offset_x + 20.0f;
+void setConnectRequestState(ConnectRequest *request, int state) {
+	if (request->generation == g_connectGeneration) {
+		setConnectionState(state);
+	}
+}
 
-		string s = "Lock to mix";
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->SetColor(g_fntMain, WHITE);
-		gfx->Write(g_fntMain, x, g_btnLockToMixMIX->getY() + g_btnLockToMixMIX->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		g_btnLockToMixMIX->draw(BTN_COLOR_GREEN);
-		for (int n = 0; n < 2; n++) {
-			g_btnLockToMixAUX[n]->draw(BTN_COLOR_GREEN);
-		}
-		for (int n = 0; n < 4; n++) {
-			g_btnLockToMixCUE[n]->draw(BTN_COLOR_GREEN);
-		}
+// a connection in the making is not the active one yet, onConnectDone hands it to tcpClientProc
+void pendingClientProc(int msg, string_view data) {
+}
 
-		s = "Label AUX 1";
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->SetColor(g_fntMain, WHITE);
-		gfx->Write(g_fntMain, x, g_btnLabelAUX1[0]->getY() + g_btnLabelAUX1[0]->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		for (int n = 0; n < 4; n++) {
-			g_btnLabelAUX1[n]->draw(BTN_COLOR_GREEN);
-		}
+int SDLCALL connectThread(void *param)
+{
+	ConnectRequest *request = (ConnectRequest*)param;
 
-		s = "Label AUX 2";
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->SetColor(g_fntMain, WHITE);
-		gfx->Write(g_fntMain, x, g_btnLabelAUX2[0]->getY() + g_btnLabelAUX2[0]->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		for (int n = 0; n < 4; n++) {
-			g_btnLabelAUX2[n]->draw(BTN_COLOR_GREEN);
+	try {
+		if (!request->servers.empty()) {
+			setConnectRequestState(request, CONNECTION_CONNECTING);
+
+			vector<TCPRaceResult> results;
+			int winner = -1;
+			try {
+				request->client = TCPClient::race(request->servers, UA_TCP_PORT, &pendingClientProc, "get /devices", results, winner);
+			}
+			catch (const invalid_argument&) {
+				logConnectRace(results, winner);
+				throw;
+			}
+			logConnectRace(results, winner);
+			request->rtt = (unsigned int)results[winner].connectTime;
+			request->connection_index = winner;
+			request->host = request->servers[winner];
 		}
+		else {
+			setConnectRequestState(request, CONNECTION_RESOLVING);
+			string ip = TCPClient::resolveHost(request->host);
 
-		s = "MIX Meter";
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->SetColor(g_fntMain, WHITE);
-		gfx->Write(g_fntMain, x, g_btnPostFaderMeter->getY() + g_btnPostFaderMeter->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		g_btnPostFaderMeter->draw(BTN_COLOR_GREEN);
+			setConnectRequestState(request, CONNECTION_CONNECTING);
+			chrono::steady_clock::time_point connectStart = chrono::steady_clock::now();
+			request->client = new TCPClient(ip, UA_TCP_PORT, &pendingClientProc);
+			request->rtt = (unsigned int)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - connectStart).count();
+		}
+	}
+	catch (const invalid_argument &error) {
+		request->error = error.what();
+	}
 
-		s = "Offline devices";
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->SetColor(g_fntMain, WHITE);
-		gfx->Write(g_fntMain, x, g_btnShowOfflineDevices->getY() + g_btnShowOfflineDevices->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		g_btnShowOfflineDevices->draw(BTN_COLOR_GREEN);
+	pushEvent(EVENT_CONNECT_DONE, request);
 
-		s = "Reconnect";
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->SetColor(g_fntMain, WHITE);
-		gfx->Write(g_fntMain, x, g_btnReconnect->getY() + g_btnReconnect->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		g_btnReconnect->draw(BTN_COLOR_GREEN);
+	return 0;
+}
 
-		s = "Server list";
-		gfx->SetColor(g_fntMain, WHITE);
-		sz = gfx->GetTextBlockSize(g_fntMain, s);
-		gfx->Write(g_fntMain, x, g_btnServerlistScan->getY() + g_btnServerlistScan->getHeight() / 2 - sz.getY() / 2.0f, 
-			shortenString(s, g_fntMain, g_settingsLabelWidth), GFX_LEFT);
-		g_btnServerlistScan->draw(BTN_COLOR_GREEN);
-		for (vector<Button*>::iterator it = g_btnsServers.begin(); it != g_btnsServers.end(); ++it) {
-			(*it)->draw(BTN_COLOR_GREEN);
+void onConnectDone(ConnectRequest *request) {
+	// disconnected or connecting somewhere else meanwhile
+	if (request->generation != g_connectGeneration) {
+		if (request->client) {
+			delete request->client;
 		}
-
-		gfx->SetColor(g_fntMain, BLACK);
+		SAFE_DELETE(request->skeleton);
+		delete request;
+		return;
 	}
-	g_btnSettings->draw(BTN_COLOR_YELLOW); // draw after settings screen
 
-	if (g_btnInfo->isHighlighted()) {
+	if (!request->client) {
+		g_msg = "Connection failed on " + request->host + ":" + UA_TCP_PORT + ": " + request->error;
+		writeLog(LOG_ERROR, "UA:  " + g_msg);
+		disconnect(true);
 
-		gfx->DrawShape(GFX_RECTANGLE, BLACK, 0, 0, win_width, win_height, 0, 0.7f);
+		// try to reconnect
+		if (g_settings.reconnect_time && g_timer_network_reconnect == 0) {
+			g_timer_network_reconnect = SDL_AddTimer(g_settings.reconnect_time, timerCallbackReconnect, NULL);
+		}
 
-		sz = gfx->GetTextBlockSize(g_fntInfo, INFO_TEXT);
-		gfx->SetColor(g_fntInfo, RGB(220,220,220));
-		gfx->SetShadow(g_fntInfo, BLACK, 1.0f);
+		delete request;
+		return;
+	}
 
-		gfx->DrawShape(GFX_RECTANGLE, WHITE, (win_width - sz.getX() - 30.0f) / 2.0f, (win_height - sz.getY() - 30.0f) / 2.0f, 
-			sz.getX() + 30.0f, sz.getY() + 30.0f, 0, 0.3f);
-		gfx->DrawShape(GFX_RECTANGLE, BLACK, (win_width - sz.getX() - 26.0f) / 2.0f, (win_height - sz.getY() - 26.0f) / 2.0f, 
-			sz.getX() + 26.0f, sz.getY() + 26.0f, 0, 0.9f);
+	int connection_index = request->connection_index;
+	g_ua_server_last_connection = connection_index;
 
-		gfx->Write(g_fntInfo, win_width / 2.0f, (win_height - sz.getY()) / 2.0f, INFO_TEXT, GFX_CENTER);
-		gfx->SetShadow(g_fntInfo, BLACK, 0);
-		gfx->SetColor(g_fntInfo, BLACK);
+	g_tcpClient = request->client;
+	if (!request->skeleton) { // a promoted standby connection is passed on by standbyProc
+		g_tcpClient->setMessageCallback(&tcpClientProc);
 	}
+	memset(&g_sendStatsLogged, 0, sizeof(TCPSendStats));
+	resetMalformedFrames();
+	g_ua_server_connected = request->host;
+	writeLog(LOG_INFO, "UA:  Connected on " + g_ua_server_connected + ":" + UA_TCP_PORT);
+	writeLog(LOG_INFO, "UA:  Socket " + g_tcpClient->getSocketInfo());
 
-	if (g_resetOrderCountdown || g_unmuteAllCountdown || g_selectAllChannelsCountdown) {
-		string msg = "Hold for ";
-		
-		if (g_resetOrderCountdown) {
-			msg += to_string(g_resetOrderCountdown) + "s to reset channel order";
-		}
-		else if(g_unmuteAllCountdown) {
-			msg += to_string(g_unmuteAllCountdown) + "s to unmute all channels";
-			if (!g_settings.lock_to_mix.empty()) {
-				msg += " of " + g_settings.lock_to_mix;
-			}
-		}
-		else if (g_selectAllChannelsCountdown) {
-			if (g_selectAllChannelsCountdown > 4) {
-				msg += to_string(g_selectAllChannelsCountdown - 4) + "s to select all channels\n or ";
-			}
-			msg += to_string(g_selectAllChannelsCountdown) + "s to unselect all channels";
-		}
+	// remember the server for the discovery on the next start
+	if (!g_serverlist_defined) {
+		g_serverCache.seen(g_ua_server_connected, request->rtt);
+		g_serverCache.save(getPrefPath(SERVER_CACHE_FILE));
+	}
+	unsigned int connect_rtt = request->rtt;
+	StandbySkeleton *skeleton = request->skeleton;
+	delete request;
 
-		sz = gfx->GetTextBlockSize(g_fntInfo, msg);
-		gfx->SetColor(g_fntInfo, WHITE);
-		gfx->SetShadow(g_fntInfo, BLACK, 1.0);
+	// a kept model is only valid for the server it was loaded from
+	if (!g_ua_devices.empty() && g_ua_server_model != g_ua_server_connected) {
+		cleanUpSendButtons();
+		cleanUpUADevices();
+	}
+	g_resyncModel = !g_ua_devices.empty();
+	g_ua_server_model = g_ua_server_connected;
+	if (g_resyncModel) {
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Resync " + to_string(g_channelsById.size()) + " channels");
+	}
+
+	setLoadingState(true);
+	setConnectionState(CONNECTION_HANDSHAKING);
+	tcpClientSend("subscribe /Session");
+	tcpClientSend("subscribe /IOMapPreset");
+	tcpClientSend("subscribe /PostFaderMetering");
+	if (skeleton) {
+		// the standby connection already knows the ids, the model is built without asking again
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Promoted standby connection");
+		pushEvent(EVENT_DEVICES_LOAD, new vector<string>(skeleton->devices), (void*)(intptr_t)true);
+		pushEvent(EVENT_SENDS_LOAD, new int(skeleton->cueBusCount));
+		pushEvent(EVENT_AUXS_LOAD, new vector<string>(skeleton->auxs), new string("0"));
+		pushEvent(EVENT_OUTPUTS_LOAD, new vector<string>(skeleton->outputs), new string("0"));
+		for (vector<string>::iterator it = skeleton->devices.begin(); it != skeleton->devices.end(); ++it) {
+			pushEvent(EVENT_INPUTS_LOAD, new vector<string>(skeleton->inputs[*it]), new string(*it));
+		}
+		SAFE_DELETE(skeleton);
+	}
+	else {
+		tcpClientSend("get /devices");
+	}
 
-		gfx->DrawShape(GFX_RECTANGLE, WHITE, (win_width - sz.getX() - 20.0f) / 2.0f, (win_height - sz.getY() - 20.0f) / 2.0f,
-			sz.getX() + 20.0f, sz.getY() + 20.0f, 0, 0.2f);
-		gfx->DrawShape(GFX_RECTANGLE, BLACK, (win_width - sz.getX() - 16.0f) / 2.0f, (win_height - sz.getY() - 16.0f) / 2.0f,
-			sz.getX() + 16.0f, sz.getY() + 16.0f, 0, 0.7f);
+	g_btnSelectChannels->setEnable(true);
+	g_btnReorderChannels->setEnable(true);
+	g_btnChannelWidth->setEnable(true);
+	g_btnMix->setEnable(true);
+	if (!g_resyncModel) {
+		g_selectedMixBus = "MIX";
+	}
+	g_btnMuteAll->setEnable(true);
 
-		gfx->Write(g_fntInfo, win_width / 2, (win_height - sz.getY()) / 2, msg, GFX_CENTER);
-		gfx->SetShadow(g_fntInfo, BLACK, 0);
-		gfx->SetColor(g_fntInfo, BLACK);
+	for (size_t n = 0; n < g_btnConnect.size(); n++) {
+		g_btnConnect[n]->setCheck(g_btnConnect[n]->getId() - ID_BTN_CONNECT == connection_index);
 	}
-	
-	gfx->Update();
-}
 
-void setLoadingState(bool loading) {
-	g_loading = loading;
-}
+	startNetworkWatchdog(connect_rtt);
+	updateStandbyConnections();
 
-bool isLoading() {
-	return g_loading;
+	setRedrawWindow(true);
 }
 
 bool connect(int connection_index)
 {
-	if (g_ua_server_connected.length()) {
-		disconnect();
+	int state = g_connectionState;
+	if ((state == CONNECTION_RESOLVING || state == CONNECTION_CONNECTING) && connection_index == g_ua_server_last_connection) {
+		return false; // already on the way
+	}
+
+	if (g_ua_server_connected.length() || state != CONNECTION_OFFLINE) {
+		disconnect(connection_index == g_ua_server_last_connection);
 	}
 
 	if (connection_index != g_ua_server_last_connection) {
+		cleanUpSendButtons();
+		cleanUpUADevices();
 		g_page = 0;
 		SDL_RemoveTimer(g_timerReenableMuteAll);
 		g_btnMuteAll->setCheck(false);
@@ -3176,66 +4635,51 @@ bool connect(int connection_index)
 	if (serverListGet(connection_index).empty())
 		return false;
 
-	//connect to UA
-	try
-	{
-		g_msg = "Connecting to " + serverListGet(connection_index) + ":" + UA_TCP_PORT;
-		writeLog(LOG_INFO | LOG_EXTENDED, g_msg);
-		draw(); // force draw
-
-		g_ua_server_last_connection = connection_index;
-
-		g_tcpClient = new TCPClient(serverListGet(connection_index), UA_TCP_PORT, &tcpClientProc);
-		g_ua_server_connected = serverListGet(connection_index);
-		writeLog(LOG_INFO, "UA:  Connected on " + serverListGet(connection_index) + ":" + UA_TCP_PORT);
-
-		setLoadingState(true);
-		tcpClientSend("subscribe /Session");
-		tcpClientSend("subscribe /IOMapPreset");
-		tcpClientSend("subscribe /PostFaderMetering");
-		tcpClientSend("get /devices");
-
-		g_btnSelectChannels->setEnable(true);
-		g_btnReorderChannels->setEnable(true);
-		g_btnChannelWidth->setEnable(true);
-		g_btnMix->setEnable(true);
-		g_selectedMixBus = "MIX";
-		g_btnMuteAll->setEnable(true);
+	g_ua_server_last_connection = connection_index;
 
-		for (size_t n = 0; n < g_btnConnect.size(); n++) {
-			if (g_btnConnect[n]->getId() - ID_BTN_CONNECT == connection_index) {
-				g_btnConnect[n]->setCheck(true);
-				break;
-			}
+	if (g_settings.standby_connections) {
+		ConnectRequest *request = promoteStandby(connection_index);
+		if (request) {
+			g_ua_server_connecting = request->host;
+			onConnectDone(request);
+			return true;
 		}
-
-		g_msg = "";
-
-		setNetworkTimeout();
-
-		setRedrawWindow(true);
 	}
-	catch (const invalid_argument &error) {
-		g_msg = "Connection failed on " + serverListGet(connection_index) + ":" + UA_TCP_PORT + ": " + error.what();
-		writeLog(LOG_ERROR, "UA:  " + g_msg);
-		disconnect();
 
-		// try to reconnect
-		if (g_settings.reconnect_time && g_timer_network_reconnect == 0) {
-			g_timer_network_reconnect = SDL_AddTimer(g_settings.reconnect_time, timerCallbackReconnect, NULL);
+	// connection setup runs in its own thread, the main loop keeps running and gets EVENT_CONNECT_DONE
+	ConnectRequest *request = new ConnectRequest;
+	request->generation = ++g_connectGeneration;
+	request->connection_index = connection_index;
+	request->host = serverListGet(connection_index);
+	request->client = NULL;
+	request->rtt = 0;
+	request->skeleton = NULL;
+	if (g_settings.connect_race) {
+		request->servers = serverListGetAll();
+		if (request->servers.size() < 2) {
+			request->servers.clear();
 		}
+	}
 
+	g_ua_server_connecting = request->host;
+	writeLog(LOG_INFO | LOG_EXTENDED, "Connecting to " + request->host + ":" + UA_TCP_PORT);
+
+	if (!startNetworkThread(connectThread, "connectThread", (void*)request)) {
+		g_msg = "Connection failed on " + request->host + ":" + UA_TCP_PORT + ": Error on creating thread";
+		writeLog(LOG_ERROR, "UA:  " + g_msg);
+		delete request;
 		return false;
 	}
+
 	return true;
 }
 
-void disconnect()
+void disconnect(bool keepModel)
 {
-	if (g_timer_network_timeout != 0) {
-		SDL_RemoveTimer(g_timer_network_timeout);
-		g_timer_network_timeout = 0;
-	}
+	g_connectGeneration++; // a connect on the way gets dropped
+	setConnectionState(CONNECTION_OFFLINE);
+
+	stopNetworkWatchdog();
 	if (g_timerFlipPage != 0) {
 		SDL_RemoveTimer(g_timerFlipPage);
 		g_timerFlipPage = 0;
@@ -3257,19 +4701,53 @@ void disconnect()
 
 	if (g_tcpClient) {
 		writeLog(LOG_INFO, "UA:  Disconnect from " + g_ua_server_connected + ":" + UA_TCP_PORT);
-		delete g_tcpClient;
+		int standbySlot = getStandbySlot(g_tcpClient);
+		if (standbySlot != -1) {
+			demoteStandby(standbySlot);
+		}
+		TCPSendStats stats = g_tcpClient->getSendStats();
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Sent " + to_string(stats.messages) + " messages, " + to_string(stats.bytes) + " bytes in "
+			+ to_string(stats.syscalls) + " syscalls and " + to_string(stats.flushes) + " flushes, " + to_string(stats.coalesced) + " values coalesced, "
+			+ to_string(stats.dropped) + " dropped");
+		if (getMalformedFrames()) {
+			writeLog(LOG_INFO, "UA:  Received " + to_string(g_framesInvalidJson.load()) + " frames with invalid JSON, " + to_string(g_framesWithoutPath.load())
+				+ " without path, " + to_string(g_framesInvalidData.load()) + " with unexpected data");
+		}
+		MeterStats meterStats = g_meterQueue.getStats();
+		writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Received " + to_string(meterStats.received) + " meter values, " + to_string(meterStats.applied) + " applied, "
+			+ to_string(meterStats.coalesced) + " coalesced, " + to_string(meterStats.dropped) + " dropped");
+		if (standbySlot == -1) {
+			delete g_tcpClient;
+		}
 		g_tcpClient = NULL;
+
+		const std::lock_guard<std::mutex> lock(g_mutex_networkRtt);
+		if (g_networkRttSamples) {
+			writeLog(LOG_INFO, "UA:  Round trip min/avg/max " + to_string(g_networkRttMin) + "/" + to_string(g_networkRttSum / g_networkRttSamples) + "/"
+				+ to_string(g_networkRttMax) + " us over " + to_string(g_networkRttSamples) + " samples, srtt " + to_string(g_networkSrtt) + " us, rttvar "
+				+ to_string(g_networkRttvar) + " us");
+		}
 	}
 
 	g_ua_server_connected = "";
-	cleanUpSendButtons();
-	cleanUpUADevices();
+	g_ua_server_connecting = "";
+	g_resyncModel = false;
+	g_meterQueue.clear();
+	g_meterDroppedLogged = 0;
+	if (keepModel) {
+		resetSubscriptions();
+	}
+	else {
+		cleanUpSendButtons();
+		cleanUpUADevices();
+		g_btnMix->setCheck(true);
+	}
 
 	for (size_t n = 0; n < g_btnConnect.size(); n++) {
 		g_btnConnect[n]->setCheck(false);
 	}
 
-	g_btnMix->setCheck(true);
+	updateStandbyConnections();
 	setRedrawWindow(true);
 }
 
@@ -4312,6 +5790,9 @@ void onStateChanged_btnFullscreen(Button* btn) {
 
 void onStateChanged_btnSimulation(Button* btn) {
 	if (btn->getState() == PRESSED) {
+		cleanUpSendButtons();
+		cleanUpUADevices();
+
 		g_ua_devices.push_back(new UADevice("0"));
 		g_ua_devices.front()->online = true;
 
@@ -4351,20 +5832,19 @@ void onStateChanged_btnSimulation(Button* btn) {
 				a = a % g_btnSends.size();
 				string sendId = to_string(a++);
 				Send* send = new Send(channel, sendId);
-				channel->sendsByName.insert({ it->first, send });
-				channel->sendsById.insert({ sendId, send });
+				channel->addSend(it->first, send);
 				send->init();
 				send->changeLevel((double)(rand() % 100) / 100.0, true);
 			}
 
-			g_channelsById.insert({ g_ua_devices.front()->id + ".input." + channel->id, channel });
+			addChannel(channel);
 			g_channelsInOrder.insert({ id, channel });
 			id++;
 			g_ua_devices.front()->channelsTotal++;
 
 			if (channel->stereo) {
 				Channel* channel = new Channel(g_ua_devices.front(), to_string(id), INPUT);
-				g_channelsById.insert({ g_ua_devices.front()->id + ".input." + channel->id, channel });
+				addChannel(channel);
 				g_channelsInOrder.insert({ id, channel });
 				id++;
 				g_ua_devices.front()->channelsTotal++;
@@ -4385,20 +5865,19 @@ void onStateChanged_btnSimulation(Button* btn) {
 				}
 				string sendId = to_string(a++);
 				Send* send = new Send(channel, sendId);
-				channel->sendsByName.insert({ it->first, send });
-				channel->sendsById.insert({ sendId, send });
+				channel->addSend(it->first, send);
 				send->init();
 				send->changeLevel((double)(rand() % 100) / 100.0, true);
 			}
 
-			g_channelsById.insert({ g_ua_devices.front()->id + ".aux." + channel->id, channel });
+			addChannel(channel);
 			g_channelsInOrder.insert({ 16 + n, channel });
 		}
 		Channel* channel = new Channel(g_ua_devices.front(), "0", MASTER);
 		channel->active = true;
 		channel->setName("MONITOR");
 		channel->changeLevel((double)(rand() % 100) / 100.0, true);
-		g_channelsById.insert({ g_ua_devices.front()->id + ".master." + channel->id, channel });
+		addChannel(channel);
 		g_channelsInOrder.insert({ 20, channel });
 
 		g_btnSelectChannels->setEnable(true);
@@ -4595,6 +6074,8 @@ void updateConnectButtons()
 	if (g_btnConnect.size() && g_ua_server_connected.empty()){
 		connect(g_btnConnect[0]->getId() - ID_BTN_CONNECT);
 	}
+
+	updateStandbyConnections();
 }
 
 void updateAllMuteBtnText() {
@@ -4868,6 +6349,7 @@ void initSettingsDialog() {
 
 void cleanUpUADevices() {
 	const std::lock_guard<std::mutex> lock(g_mutex_uaDevices);
+	discardModelUpdates();
 	clearChannels();
 	for (vector<UADevice*>::iterator it = g_ua_devices.begin(); it != g_ua_devices.end(); ++it) {
 		SAFE_DELETE(*it);
@@ -5132,6 +6614,74 @@ bool Settings::load(const string &json) {
 		}
 		catch (const simdjson_error&) {}
 
+		try {
+			int64_t discovery_probes = element["network"]["discovery_probes"];
+			this->discovery_probes = (unsigned int)max(discovery_probes, (int64_t)1);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t discovery_rate = element["network"]["discovery_rate"];
+			this->discovery_rate = (unsigned int)max(discovery_rate, (int64_t)0);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			this->connect_race = element["network"]["connect_race"];
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			this->standby_connections = element["network"]["standby_connections"];
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			this->socket_profile.nodelay = element["network"]["tcp_nodelay"];
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			this->socket_profile.keepalive = element["network"]["tcp_keepalive"];
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t keepalive_idle = element["network"]["keepalive_idle"];
+			this->socket_profile.keepalive_idle = (int)max(keepalive_idle, (int64_t)0);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t keepalive_interval = element["network"]["keepalive_interval"];
+			this->socket_profile.keepalive_interval = (int)max(keepalive_interval, (int64_t)0);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t keepalive_count = element["network"]["keepalive_count"];
+			this->socket_profile.keepalive_count = (int)max(keepalive_count, (int64_t)0);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t rcvbuf = element["network"]["rcvbuf"];
+			this->socket_profile.rcvbuf = (int)max(rcvbuf, (int64_t)0);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t sndbuf = element["network"]["sndbuf"];
+			this->socket_profile.sndbuf = (int)max(sndbuf, (int64_t)0);
+		}
+		catch (const simdjson_error&) {}
+
+		try {
+			int64_t dscp = element["network"]["dscp"];
+			this->socket_profile.dscp = (int)min(max(dscp, (int64_t)0), (int64_t)63);
+		}
+		catch (const simdjson_error&) {}
+
 		try {
 			this->maximized = element["window"]["maximized"];
 			this->fullscreen = element["window"]["fullscreen"];
@@ -5201,6 +6751,34 @@ string Settings::toJSON() {
         json+="\"extended_logging\": false\n";
     json+="},\n";
 
+    //NETWORK
+    json+="\"network\": {\n";
+    json+="\"discovery_probes\": " + to_string(this->discovery_probes) + ",\n";
+    json+="\"discovery_rate\": " + to_string(this->discovery_rate) + ",\n";
+    if(this->connect_race)
+        json+="\"connect_race\": true,\n";
+    else
+        json+="\"connect_race\": false,\n";
+    if(this->standby_connections)
+        json+="\"standby_connections\": true,\n";
+    else
+        json+="\"standby_connections\": false,\n";
+    if(this->socket_profile.nodelay)
+        json+="\"tcp_nodelay\": true,\n";
+    else
+        json+="\"tcp_nodelay\": false,\n";
+    if(this->socket_profile.keepalive)
+        json+="\"tcp_keepalive\": true,\n";
+    else
+        json+="\"tcp_keepalive\": false,\n";
+    json+="\"keepalive_idle\": " + to_string(this->socket_profile.keepalive_idle) + ",\n";
+    json+="\"keepalive_interval\": " + to_string(this->socket_profile.keepalive_interval) + ",\n";
+    json+="\"keepalive_count\": " + to_string(this->socket_profile.keepalive_count) + ",\n";
+    json+="\"rcvbuf\": " + to_string(this->socket_profile.rcvbuf) + ",\n";
+    json+="\"sndbuf\": " + to_string(this->socket_profile.sndbuf) + ",\n";
+    json+="\"dscp\": " + to_string(this->socket_profile.dscp) + "\n";
+    json+="},\n";
+
     //WINDOW
     int x, y, w, h;
     SDL_GetWindowSize(g_window, &w, &h);
@@ -5266,10 +6844,18 @@ bool Settings::save()
 void initGlobals() { // needed to reset globals for android
 	g_running = true;
 	g_window = NULL;
+	g_connectionState = CONNECTION_OFFLINE;
+	g_connectGeneration = 0;
 	g_timer_network_serverlist = 0;
 	g_timer_network_reconnect = 0;
-	g_timer_network_timeout = 0;
-	g_timer_network_send_timeout_msg = 0;
+	g_timer_network_watchdog = 0;
+	g_timer_standby = 0;
+	g_networkLastFrame = 0;
+	g_networkLastProbe = 0;
+	g_networkProbePending = 0;
+	g_networkRto = NETWORK_RTO_INITIAL;
+	g_networkSrtt = -1;
+	g_networkRttvar = 0;
 	g_timerFlipPage = 0;
 	g_timerResetOrder = 0;
 	g_timerUnmuteAll = 0;
@@ -5280,6 +6866,8 @@ void initGlobals() { // needed to reset globals for android
 	g_selectAllChannelsCountdown = 0;
 	g_ua_server_connected = "";
 	g_ua_server_last_connection = -1;
+	g_ua_server_model = "";
+	g_resyncModel = false;
 	g_msg = "";
 	g_selectedMixBus = "MIX";
 	g_channels_per_page = 0;
@@ -5311,6 +6899,12 @@ void initGlobals() { // needed to reset globals for android
 	g_btnServerlistScan = NULL;
 	g_tcpClient = NULL;
 	g_page = 0;
+	g_recording = false;
+	g_replayFile = "";
+	g_replaySpeed = 1.0;
+	g_replayStop = false;
+	g_meterDroppedLogged = 0;
+	resetMalformedFrames();
 	g_fntMain = NULL;
 	g_fntInfo = NULL;
 	g_fntChannelBtn = NULL;
@@ -5329,6 +6923,8 @@ int main(int argc, char* argv[]) {
 #endif
 
 	initGlobals();
+	initRoutes();
+	initStandbyRoutes();
 	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_EVENTS);
 	g_userEventBeginNum = SDL_RegisterEvents(USER_EVENT_COUNT);
 	SDL_LogSetAllPriority(SDL_LOG_PRIORITY_INFO);
@@ -5370,6 +6966,21 @@ int main(int argc, char* argv[]) {
 			if (key == "delay") {
 				startup_delay = (unsigned int)stoul(value);
 			}
+			else if (key == "record") {
+				if (g_recorder.open(value)) {
+					g_recording = true;
+					writeLog(LOG_INFO, "Recording to " + value);
+				}
+				else {
+					writeLog(LOG_ERROR, "Can't record to " + value);
+				}
+			}
+			else if (key == "replay") {
+				g_replayFile = value;
+			}
+			else if (key == "replay_speed") {
+				g_replaySpeed = max(0.0, atof(value.c_str())); // 0 = as fast as possible
+			}
 		}
 	}
 
@@ -5450,15 +7061,22 @@ int main(int argc, char* argv[]) {
         updateLayout();
         setRedrawWindow(true);
 
-#ifdef _WIN32
-        TCPClient::initNetwork();
-#endif
+        if (!TCPClient::initNetwork()) {
+            writeLog(LOG_ERROR, "init network failed");
+        }
+        TCPClient::setSocketProfile(g_settings.socket_profile);
+        if (!g_serverCache.load(getPrefPath(SERVER_CACHE_FILE))) {
+            writeLog(LOG_INFO | LOG_EXTENDED, "no server cache found");
+        }
         for (int n = 0; n < UA_MAX_SERVER_LIST; n++) {
             if (!g_settings.serverlist[n].empty()) {
                 serverListAdd(g_settings.serverlist[n]);
             }
         }
-        if (!g_ua_serverList.empty()) // serverliste wurde definiert, automatische Serversuche wird nicht ausgeführt
+        if (!g_replayFile.empty()) {
+            startReplay();
+        }
+        else if (!g_ua_serverList.empty()) // serverliste wurde definiert, automatische Serversuche wird nicht ausgeführt
         {
             g_serverlist_defined = true;
             updateConnectButtons();
@@ -5467,6 +7085,7 @@ int main(int argc, char* argv[]) {
             g_serverlist_defined = false;
             getServerList();
         }
+        updateStandbyTimer();
         
         SDL_Event e;
 		unsigned long long maxFpsTimer = 0;
@@ -5812,7 +7431,13 @@ int main(int argc, char* argv[]) {
 						}
 						break;
 					case EVENT_DISCONNECT:
-						disconnect();
+						disconnect((bool)(intptr_t)e.user.data1);
+						break;
+					case EVENT_CONNECTION_STATE:
+						onConnectionStateChanged((int)(intptr_t)e.user.data1);
+						break;
+					case EVENT_CONNECT_DONE:
+						onConnectDone((ConnectRequest*)e.user.data1);
 						break;
 					case EVENT_DEVICES_INITIATE_RELOAD:
 						cleanUpUADevices();
@@ -5822,21 +7447,50 @@ int main(int argc, char* argv[]) {
 					case EVENT_DEVICES_LOAD:
 					{
 						vector<string>* strDevices = (vector<string>*)e.user.data1;
-						cleanUpUADevices();
+						bool fromSkeleton = (bool)(intptr_t)e.user.data2; // the channel ids follow without asking
+						if (getConnectionState() == CONNECTION_HANDSHAKING) {
+							setConnectionState(CONNECTION_LOADING);
+						}
 						//load device info
 						tcpClientSend("subscribe /devices/0/CueBusCount");
 						g_mutex_uaDevices.lock();
+						// reconcile a kept model, only vanished devices are removed and new ones added
+						for (vector<UADevice*>::iterator it = g_ua_devices.begin(); it != g_ua_devices.end();) {
+							if (find(strDevices->begin(), strDevices->end(), (*it)->id) == strDevices->end()) {
+								writeLog(LOG_INFO | LOG_EXTENDED, "UA:  Device " + (*it)->id + " vanished");
+								removeVanishedChannels(*it, INPUT, vector<string>());
+								removeVanishedChannels(*it, AUX, vector<string>());
+								removeVanishedChannels(*it, MASTER, vector<string>());
+								SAFE_DELETE(*it);
+								it = g_ua_devices.erase(it);
+							}
+							else {
+								++it;
+							}
+						}
 						for (vector<string>::iterator it = strDevices->begin(); it != strDevices->end(); ++it) {
-							UADevice* dev = new UADevice(*it);
-							if (dev) {
-								g_ua_devices.push_back(dev);
+							bool known = false;
+							for (vector<UADevice*>::iterator itD = g_ua_devices.begin(); itD != g_ua_devices.end(); ++itD) {
+								if ((*itD)->id == *it) {
+									known = true;
+									break;
+								}
+							}
+							if (!known) {
+								g_ua_devices.push_back(new UADevice(*it));
 							}
 						}
-						if (!g_ua_devices.empty()) {
+						for (auto it = g_ua_devices.begin(); it != g_ua_devices.end(); ++it) {
+							(*it)->init();
+						}
+						if (g_ua_devices.empty()) {
+							g_resyncModel = false;
+						}
+						if (!g_ua_devices.empty() && !fromSkeleton) {
 							tcpClientSend("get /devices/0/auxs");
 							tcpClientSend("get /devices/0/outputs");
 						}
-						for (auto it = g_ua_devices.begin(); it != g_ua_devices.end(); ++it) {
+						for (auto it = g_ua_devices.begin(); it != g_ua_devices.end() && !fromSkeleton; ++it) {
 							tcpClientSend("get /devices/" + (*it)->id + "/inputs");
 						}
 						g_mutex_uaDevices.unlock();
@@ -5848,6 +7502,12 @@ int main(int argc, char* argv[]) {
 					{
 						int* cueBusCount = (int*)e.user.data1;
 						if (*cueBusCount + 2 != (int)g_btnSends.size()) {
+							if (g_resyncModel) {
+								// the sends of the kept channels don't match anymore
+								g_resyncModel = false;
+								cleanUpUADevices();
+								tcpClientSend("get /devices");
+							}
 							cleanUpSendButtons();
 
 							// cues
@@ -5876,13 +7536,22 @@ int main(int argc, char* argv[]) {
 
 						UADevice* dev = getDeviceByUAId(*devStr);
 						if (dev) {
+							removeVanishedChannels(dev, INPUT, *pIds);
 							//load device info
 							for (vector<string>::iterator it = pIds->begin(); it != pIds->end(); ++it) {
 
-								if (g_channelsById.find(dev->id + ".input." + *it) == g_channelsById.end()) {
+								unordered_map<string, Channel*>::iterator itC = g_channelsById.find(dev->id + ".input." + *it);
+								if (itC != g_channelsById.end()) {
+									// kept from the last connection
+									itC->second->init();
+									for (unordered_map<string, Send*>::iterator itS = itC->second->sendsById.begin(); itS != itC->second->sendsById.end(); ++itS) {
+										itS->second->init();
+									}
+								}
+								else {
 									Channel* channel = new Channel(dev, *it, INPUT);
-									g_channelsById.insert({ dev->id + ".input." + *it, channel });
-									int order = (int)g_channelsInOrder.size();
+									addChannel(channel);
+									int order = getFreeChannelOrder((int)g_channelsInOrder.size());
 									g_channelsInOrder.insert({ order, channel });
 									channel->init();
 									dev->channelsTotal++;
@@ -5892,18 +7561,29 @@ int main(int argc, char* argv[]) {
 										n = n % g_btnSends.size();
 										string sendId = to_string(n++);
 										Send* send = new Send(channel, sendId);
-										channel->sendsByName.insert({ it->first, send });
-										channel->sendsById.insert({ sendId, send });
+										channel->addSend(it->first, send);
 										send->init();
 									}
 								}
 							}
 							if (dev == g_ua_devices.back()) {
-								loadServerSettings(g_ua_server_connected);
-								int* index = new int;
-								*index = g_browseToChannel;
-								pushEvent(EVENT_BROWSE_TO_CHANNEL, index);
-								setLoadingState(false);
+								if (g_resyncModel) {
+									// order, selection and page are still in place, only the visible channels subscribe again
+									g_resyncModel = false;
+									setLoadingState(false);
+									g_activeChannelsCount = -1;
+									g_visibleChannelsCount = -1;
+									updateMaxPages(!g_btnSelectChannels->isHighlighted());
+									updateSubscriptions();
+									setRedrawWindow(true);
+								}
+								else {
+									loadServerSettings(g_ua_server_connected);
+									int* index = new int;
+									*index = g_browseToChannel;
+									pushEvent(EVENT_BROWSE_TO_CHANNEL, index);
+									setLoadingState(false);
+								}
 							}
 						}
 						SAFE_DELETE(devStr);
@@ -5917,13 +7597,22 @@ int main(int argc, char* argv[]) {
 
 						UADevice* dev = getDeviceByUAId(*devStr);
 						if (dev && dev->id == "0") {
+							removeVanishedChannels(dev, AUX, *pIds);
 							//load device info
 							for (vector<string>::iterator it = pIds->begin(); it != pIds->end(); ++it) {
 
-								if (g_channelsById.find(dev->id + ".aux." + *it) == g_channelsById.end()) {
+								unordered_map<string, Channel*>::iterator itC = g_channelsById.find(dev->id + ".aux." + *it);
+								if (itC != g_channelsById.end()) {
+									// kept from the last connection
+									itC->second->init();
+									for (unordered_map<string, Send*>::iterator itS = itC->second->sendsById.begin(); itS != itC->second->sendsById.end(); ++itS) {
+										itS->second->init();
+									}
+								}
+								else {
 									Channel* channel = new Channel(dev, *it, AUX);
-									g_channelsById.insert({ dev->id + ".aux." + *it, channel });
-									int order = (int)g_channelsInOrder.size() + 1024; // ans ende sortieren
+									addChannel(channel);
+									int order = getFreeChannelOrder((int)g_channelsInOrder.size() + 1024); // ans ende sortieren
 									g_channelsInOrder.insert({ order, channel });
 									channel->init();
 
@@ -5937,8 +7626,7 @@ int main(int argc, char* argv[]) {
 										}
 										string sendId = to_string(n++);
 										Send* send = new Send(channel, sendId);
-										channel->sendsByName.insert({ it->first, send });
-										channel->sendsById.insert({ sendId, send });
+										channel->addSend(it->first, send);
 										send->init();
 									}
 								}
@@ -5955,13 +7643,19 @@ int main(int argc, char* argv[]) {
 
 						UADevice* dev = getDeviceByUAId(*devStr);
 						if (dev && dev->id == "0") {
+							removeVanishedChannels(dev, MASTER, *pIds);
 							//load device info
 							for (vector<string>::iterator it = pIds->begin(); it != pIds->end(); ++it) {
 
-								if (g_channelsById.find(dev->id + ".master." + *it) == g_channelsById.end()) {
+								unordered_map<string, Channel*>::iterator itC = g_channelsById.find(dev->id + ".master." + *it);
+								if (itC != g_channelsById.end()) {
+									// kept from the last connection
+									itC->second->init();
+								}
+								else {
 									Channel* channel = new Channel(dev, *it, MASTER);
-									g_channelsById.insert({ dev->id + ".master." + *it, channel });
-									int order = (int)g_channelsInOrder.size() + 2048; // ans ende sortieren
+									addChannel(channel);
+									int order = getFreeChannelOrder((int)g_channelsInOrder.size() + 2048); // ans ende sortieren
 									g_channelsInOrder.insert({ order, channel });
 									channel->init();
 								}
@@ -6016,6 +7710,9 @@ int main(int argc, char* argv[]) {
 					case EVENT_UPDATE_CONNECT_BUTTONS:
 						updateConnectButtons();
 						break;
+					case EVENT_STANDBY_UPDATE:
+						updateStandbyConnections();
+						break;
 					case EVENT_RESET_ORDER:
 					{
 						g_mutex_uaDevices.lock();
@@ -6058,6 +7755,11 @@ int main(int argc, char* argv[]) {
 				}
 			}
 
+			tcpClientLogSendStats();
+			tcpClientLogReceiveStats();
+			applyModelUpdates();
+			applyMeterValues();
+
 			if (getRedrawWindow() && GetTickCount64() - maxFpsTimer > 16) { // max aprox 60fps
 				maxFpsTimer = GetTickCount64();
                 setRedrawWindow(false);
@@ -6084,11 +7786,22 @@ int main(int argc, char* argv[]) {
 void cleanUp() {
 	writeLog(LOG_INFO | LOG_EXTENDED, "terminate threads");
     disconnect();
+    if (g_timer_standby != 0) {
+        SDL_RemoveTimer(g_timer_standby);
+        g_timer_standby = 0;
+    }
+    closeStandbyConnections();
+    g_recording = false;
+    g_recorder.close();
 	g_ua_serverList.clear();
 
-#ifdef _WIN32
+	// scans and connects still running fail now and a replay stops; their threads (and the name
+	// lookups of the server list thread) end before the network and the gui objects are released
+	TCPClient::cancelNetwork();
+	g_replayStop = true;
+	writeLog(LOG_INFO | LOG_EXTENDED, "wait for network threads");
+	waitForNetworkThreads();
     TCPClient::releaseNetwork();
-#endif
 
 	writeLog(LOG_INFO | LOG_EXTENDED, "clean up gui objects");
     cleanUpConnectionButtons();
@@ -34,7 +34,13 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 #include "gfx2d_sdl.h"
 #include "simdjson.h"
+#include "servercache.h"
+#include "recorder.h"
+#include "meterqueue.h"
+#include "pathrouter.h"
+#include "mpscqueue.h"
 #include <map>
+#include <array>
 #include <queue>
 
 #ifdef __ANDROID__
@@ -77,10 +83,31 @@ https://github.com/franqulator/cuefinger";
 
 #define UA_MAX_SERVER_LIST	3 //könnte mehr sein, wenn mir eine GUI-Lösung einfällt
 #define UA_TCP_PORT		"4710"
-#define SERVER_TEST_TIMEOUT			3000
+#define SERVER_TEST_TIMEOUT			1000 // per probe
+// the 1022 hosts of a /22 are two rounds of SERVER_SCAN_PROBES, each taking 0.5 s at SERVER_SCAN_RATE
+// plus SERVER_TEST_TIMEOUT for hosts that do not answer: the scan ends after about 2.5 s
+#define SERVER_SCAN_MIN_NETMASK		0xFFFFFC00 // larger subnets are cut down to the /22 around the client
+#define SERVER_SCAN_PROBES			512
+#define SERVER_SCAN_RATE			1000 // probes per second
+#define SERVER_CACHE_TIMEOUT		300 // probe timeout for servers found on previous runs
+#define STANDBY_UPDATE_TIME			5000 // ms, lost standby connections are reopened
+#define NETWORK_PROBE_MIN			250 // ms, liveness probe interval on fast links
+#define NETWORK_PROBE_TIME			4000 // ms, liveness probe interval on slow links
+#define NETWORK_TIMEOUT_MIN			300 // ms a probe answer may take at least
+#define NETWORK_TIMEOUT				10000 // ms without a frame until the connection is considered dead at most
+#define NETWORK_RTO_MIN				50 // ms
+#define NETWORK_RTO_MAX				3000 // ms
+#define NETWORK_RTO_INITIAL			1000 // ms, until the first round trip is measured
 
 #define UA_MAX_SERVER_LIST_SETTING	7 
 
+#define CONNECTION_OFFLINE			0
+#define CONNECTION_RESOLVING		1
+#define CONNECTION_CONNECTING		2
+#define CONNECTION_HANDSHAKING		3 // connected, waiting for the devices
+#define CONNECTION_LOADING			4
+#define CONNECTION_LIVE				5
+
 #define MUTE_ALL_CHANNEL_INTERVAL	10
 
 #define ID_BTN_CONNECT			50 // +connection index
@@ -119,6 +146,8 @@ https://github.com/franqulator/cuefinger";
 #define INPUT	0
 #define AUX		1
 #define MASTER	2
+#define UA_CHANNEL_TYPES	3
+#define UA_MAX_INDEX	4096 // numeric UA ids above are not indexed
 
 #define SWITCH	-1
 #define ON		1
@@ -174,6 +203,11 @@ public:
 	bool show_offline_devices;
 	string label_aux1;
 	string label_aux2;
+	unsigned int discovery_probes; // parallel probes on server discovery
+	unsigned int discovery_rate; // probes per second on server discovery, 0 = unlimited
+	bool connect_race; // connect to all servers of the list at once, the first one answering wins
+	bool standby_connections; // keep connections to the other servers of the list open for instant switching
+	TCPSocketProfile socket_profile;
 
 	Settings() {
 		x = 0;
@@ -189,6 +223,18 @@ public:
 		show_offline_devices = false;
 		label_aux1 = "AUX";
 		label_aux2 = "AUX";
+		discovery_probes = SERVER_SCAN_PROBES;
+		discovery_rate = SERVER_SCAN_RATE;
+		connect_race = false;
+		standby_connections = false;
+		socket_profile.nodelay = true;
+		socket_profile.keepalive = true;
+		socket_profile.keepalive_idle = 5;
+		socket_profile.keepalive_interval = 1;
+		socket_profile.keepalive_count = 3;
+		socket_profile.rcvbuf = 0;
+		socket_profile.sndbuf = 0;
+		socket_profile.dscp = 0;
 	}
 	bool load(const string& json = "");
 	bool save();
@@ -250,6 +296,7 @@ public:
 	int channelsTotal;
 	UADevice(const string &us_deviceId);
 	~UADevice();
+	void init();
 };
 
 class Module {
@@ -299,6 +346,7 @@ public:
 	bool post_fader;
 	unordered_map<string, Send*> sendsByName;
 	unordered_map<string, Send*> sendsById;
+	vector<Send*> sendSlots; // sendsById indexed by the numeric UA id
 	bool stereo;
 	bool hidden;
 	bool enabledByUser;
@@ -328,7 +376,8 @@ public:
 	bool isOverriddenHide();
 	bool isVisible(bool only_selected);
 	Send* getSendByName(const string &name);
-	Send* getSendByUAId(const string &id);
+	void addSend(const string &name, Send *send);
+	Send* getSendByUAIndex(unsigned index);
 	void updateProperties();
 	string getName();
 	void setName(const string &name);
@@ -343,9 +392,46 @@ public:
 	void pressMute(int state = SWITCH) override;
 };
 
+typedef void (*UARouteHandler)(const PathMatch &match, dom::element element);
+
+#define MODEL_QUEUE_SIZE	8192 // values waiting for the main loop, more wait in an overflow under a lock
+
+#define MODEL_SEND_GAIN			0
+#define MODEL_SEND_PAN			1
+#define MODEL_SEND_BYPASS		2
+#define MODEL_FADER_LEVEL		3
+#define MODEL_CR_MONITOR_LEVEL	4
+#define MODEL_NAME				5
+#define MODEL_PAN				6
+#define MODEL_PAN2				7
+#define MODEL_SOLO				8
+#define MODEL_SEND_POST_FADER	9
+#define MODEL_MUTE				10
+#define MODEL_STEREO			11
+#define MODEL_STEREO_NAME		12
+#define MODEL_CHANNEL_HIDDEN	13
+#define MODEL_ENABLED_BY_USER	14
+#define MODEL_ACTIVE			15
+
+// a value UA sent for a channel or a send; the receiving threads only queue it,
+// Channel and Send are changed by the main loop alone
+struct ModelUpdate {
+	int property; // MODEL_*
+	int type; // INPUT, AUX, MASTER
+	unsigned device;
+	unsigned channel;
+	unsigned send; // MODEL_SEND_* only
+	double value; // bool as 0.0 or 1.0
+	string name; // MODEL_NAME, MODEL_STEREO_NAME
+};
+
 void tcpClientSend(const string &msg);
+void tcpClientLogSendStats();
+void tcpClientLogReceiveStats();
+void applyModelUpdates();
+void applyMeterValues();
 bool connect(int);
-void disconnect();
+void disconnect(bool keepModel = false);
 void draw();
 bool loadAllGfx();
 void releaseAllGfx();
@@ -367,6 +453,9 @@ void updateChannelWidthButton();
 void muteChannels(bool, bool);
 int getActiveChannelsCount(bool onlyVisible);
 void setLoadingState(bool loading);
+void setConnectionState(int state);
+int getConnectionState();
+string getConnectionStateName(int state);
 bool isLoading();
 
 inline double toDbFS(double linVal) {
@@ -0,0 +1,236 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "meterqueue.h"
+#include <math.h>
+
+static bool skipLiteral(string_view frame, size_t &pos, string_view literal) {
+	if (frame.compare(pos, literal.length(), literal) != 0) {
+		return false;
+	}
+	pos += literal.length();
+	return true;
+}
+
+static bool readIndex(string_view frame, size_t &pos, unsigned &index) {
+	size_t start = pos;
+	index = 0;
+	while (pos < frame.length() && frame[pos] >= '0' && frame[pos] <= '9') {
+		index = index * 10 + (unsigned)(frame[pos] - '0');
+		pos++;
+		if (index >= METER_MAX_INDEX) {
+			return false;
+		}
+	}
+	return pos > start;
+}
+
+static bool readNumber(string_view frame, size_t &pos, double &value) { // JSON number
+	bool negative = skipLiteral(frame, pos, "-");
+	uint64_t mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	size_t start = pos;
+	while (pos < frame.length() && frame[pos] >= '0' && frame[pos] <= '9') {
+		if (digits < 18) {
+			mantissa = mantissa * 10 + (uint64_t)(frame[pos] - '0');
+			if (mantissa) {
+				digits++;
+			}
+		}
+		else {
+			exponent++;
+		}
+		pos++;
+	}
+	if (pos == start) {
+		return false;
+	}
+	if (skipLiteral(frame, pos, ".")) {
+		start = pos;
+		while (pos < frame.length() && frame[pos] >= '0' && frame[pos] <= '9') {
+			if (digits < 18) {
+				mantissa = mantissa * 10 + (uint64_t)(frame[pos] - '0');
+				if (mantissa) {
+					digits++;
+				}
+				exponent--;
+			}
+			pos++;
+		}
+		if (pos == start) {
+			return false;
+		}
+	}
+	if (pos < frame.length() && (frame[pos] == 'e' || frame[pos] == 'E')) {
+		pos++;
+		bool negativeExponent = false;
+		if (!skipLiteral(frame, pos, "+")) {
+			negativeExponent = skipLiteral(frame, pos, "-");
+		}
+		unsigned e;
+		if (!readIndex(frame, pos, e)) {
+			return false;
+		}
+		exponent += negativeExponent ? -(int)e : (int)e;
+	}
+
+	static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+	value = (double)mantissa;
+	if (exponent < 0 && exponent >= -22) {
+		value /= powers[-exponent];
+	}
+	else if (exponent > 0 && exponent <= 22) {
+		value *= powers[exponent];
+	}
+	else if (exponent != 0) {
+		value *= pow(10.0, exponent);
+	}
+	if (negative) {
+		value = -value;
+	}
+	return true;
+}
+
+bool parseMeterFrame(string_view frame, MeterFrame &meter) {
+	// {"path":"/devices/0/inputs/3/sends/2/meters/0/MeterLevel/value","data":-52.3}
+	size_t pos = 0;
+	if (!skipLiteral(frame, pos, "{\"path\":\"/devices/") || !readIndex(frame, pos, meter.device)) {
+		return false;
+	}
+	if (skipLiteral(frame, pos, "/inputs/")) {
+		meter.type = METER_INPUT;
+	}
+	else if (skipLiteral(frame, pos, "/auxs/")) {
+		meter.type = METER_AUX;
+	}
+	else if (skipLiteral(frame, pos, "/outputs/")) {
+		meter.type = METER_MASTER;
+	}
+	else {
+		return false;
+	}
+	if (!readIndex(frame, pos, meter.channel)) {
+		return false;
+	}
+	meter.send = -1;
+	if (skipLiteral(frame, pos, "/sends/")) {
+		unsigned send;
+		if (!readIndex(frame, pos, send)) {
+			return false;
+		}
+		meter.send = (int)send;
+	}
+	if (!skipLiteral(frame, pos, "/meters/") || !readIndex(frame, pos, meter.meter)) {
+		return false;
+	}
+	if (skipLiteral(frame, pos, "/MeterLevel/value")) {
+		meter.clip = false;
+	}
+	else if (skipLiteral(frame, pos, "/MeterClip/value")) {
+		meter.clip = true;
+	}
+	else {
+		return false;
+	}
+	skipLiteral(frame, pos, "/");
+	if (!skipLiteral(frame, pos, "\",\"data\":")) {
+		return false;
+	}
+
+	if (meter.clip) {
+		if (skipLiteral(frame, pos, "true")) {
+			meter.value = 1.0;
+		}
+		else if (skipLiteral(frame, pos, "false")) {
+			meter.value = 0.0;
+		}
+		else {
+			return false;
+		}
+	}
+	else if (!readNumber(frame, pos, meter.value)) {
+		return false;
+	}
+	return skipLiteral(frame, pos, "}") && pos == frame.length();
+}
+
+uint64_t MeterQueue::getKey(const MeterFrame &meter) {
+	return ((uint64_t)meter.device << 48) | ((uint64_t)meter.type << 44) | ((uint64_t)meter.channel << 30)
+		| ((uint64_t)(meter.send + 1) << 16) | ((uint64_t)meter.meter << 1) | (meter.clip ? 1 : 0);
+}
+
+MeterQueue::MeterQueue(size_t capacity) {
+	this->capacity = capacity;
+	this->stats = { 0, 0, 0, 0 };
+}
+
+bool MeterQueue::push(const MeterFrame &meter) {
+	lock_guard<mutex> lock(this->mtx);
+	return this->add(meter);
+}
+
+void MeterQueue::push(const vector<MeterFrame> &meters) {
+	lock_guard<mutex> lock(this->mtx);
+	for (vector<MeterFrame>::const_iterator it = meters.begin(); it != meters.end(); ++it) {
+		this->add(*it);
+	}
+}
+
+bool MeterQueue::add(const MeterFrame &meter) { // mtx locked
+	uint64_t key = getKey(meter);
+	this->stats.received++;
+
+	unordered_map<uint64_t, size_t>::iterator it = this->pendingIndex.find(key);
+	if (it != this->pendingIndex.end()) {
+		this->pending[it->second].value = meter.value;
+		this->stats.coalesced++;
+		return true;
+	}
+	if (this->pending.size() >= this->capacity) {
+		this->stats.dropped++;
+		return false;
+	}
+	this->pendingIndex[key] = this->pending.size();
+	this->pending.push_back(meter);
+	return true;
+}
+
+size_t MeterQueue::take(vector<MeterFrame> &meters) {
+	meters.clear();
+	lock_guard<mutex> lock(this->mtx);
+	meters.swap(this->pending);
+	this->pendingIndex.clear();
+	this->stats.applied += meters.size();
+	return meters.size();
+}
+
+void MeterQueue::clear() { // drops the pending values and starts new stats
+	lock_guard<mutex> lock(this->mtx);
+	this->pending.clear();
+	this->pendingIndex.clear();
+	this->stats = { 0, 0, 0, 0 };
+}
+
+MeterStats MeterQueue::getStats() {
+	lock_guard<mutex> lock(this->mtx);
+	return this->stats;
+}
@@ -0,0 +1,91 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _METERQUEUE_
+#define _METERQUEUE_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include <mutex>
+
+using namespace std;
+
+#define METER_QUEUE_SIZE	1024 // different meters waiting for the main loop
+#define METER_MAX_INDEX		4096 // device, channel, send and meter ids of the fast path are below
+
+#define METER_INPUT		0 // same as INPUT, AUX, MASTER
+#define METER_AUX		1
+#define METER_MASTER	2
+
+// one received meter value:
+// /devices/<device>/<inputs|auxs|outputs>/<channel>[/sends/<send>]/meters/<meter>/<MeterLevel|MeterClip>/value
+struct MeterFrame {
+	unsigned device;
+	int type;
+	unsigned channel;
+	int send;		// -1 = meter of the channel itself
+	unsigned meter;	// 0 = left/mono, 1 = right
+	bool clip;		// MeterClip, otherwise MeterLevel
+	double value;	// dBFS, 1.0/0.0 for MeterClip
+};
+
+struct MeterStats {
+	size_t received;	// meter values handed over by the network thread
+	size_t applied;		// values taken by the main loop
+	size_t coalesced;	// values replaced by a newer value of the same meter before being applied
+	size_t dropped;		// values dropped because too many meters were pending
+};
+
+// Fast path for the bulk of the received frames: recognizes a meter frame in the exact
+// form the server sends, {"path":"<meter path>","data":<value>}, and reads the ids and
+// the value without the JSON parser. Anything else returns false and goes the general way.
+bool parseMeterFrame(string_view frame, MeterFrame &meter);
+
+// Coalescing stage between the network thread and the main loop for meter values.
+// push() keeps only the newest value per meter until the main loop takes all
+// pending values with take() once per round, so a main loop falling behind sees
+// one value per meter instead of a growing backlog.
+// Overload policy: while METER_QUEUE_SIZE different meters are pending, values of
+// further meters are dropped. Control values (FaderLevel, Mute, Name, ...) never
+// pass this queue and keep their order.
+class MeterQueue
+{
+private:
+	mutex mtx;
+	vector<MeterFrame> pending;
+	unordered_map<uint64_t, size_t> pendingIndex; // meter key -> index in pending
+	size_t capacity;
+	MeterStats stats;
+	static uint64_t getKey(const MeterFrame &meter);
+	bool add(const MeterFrame &meter);
+public:
+	MeterQueue(size_t capacity = METER_QUEUE_SIZE);
+	bool push(const MeterFrame &meter);
+	void push(const vector<MeterFrame> &meters); // one lock for the meters of a batch
+	size_t take(vector<MeterFrame> &meters);
+	void clear();
+	MeterStats getStats();
+};
+
+#endif
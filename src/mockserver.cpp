@@ -0,0 +1,573 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+// Stand-in for UA Console on port 4710 for load and latency tests without an Apollo.
+// Speaks the same NUL framed protocol, answers get, subscribe, unsubscribe and set
+// and streams MeterLevel values for all subscribed meters at a configurable rate.
+//
+// build: make mockserver (in src), run: ../build/linux/cuefinger-mockserver --help
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <chrono>
+#include <algorithm>
+
+using namespace std;
+
+#define MOCK_MAX_EVENTS		64
+#define MOCK_READ_SIZE		65536
+#define MOCK_MAX_PENDING	(16 * 1024 * 1024) // bytes a client may fall behind before it gets dropped
+
+struct MockOptions {
+	int port;
+	int devices;
+	int inputs; // per device
+	int auxs;
+	int cues;
+	int meterRate; // meter updates per second and meter
+	bool verbose;
+};
+
+struct MockClient {
+	int sock;
+	string in;
+	string out;
+	bool waitsWritable;
+	set<string> subscriptions; // property paths
+};
+
+map<string, string> g_properties; // path -> value as json
+map<int, MockClient*> g_clients;
+int g_epoll = -1;
+MockOptions g_options;
+bool g_running = true;
+
+unsigned long long g_framesSent = 0;
+unsigned long long g_bytesSent = 0;
+unsigned long long g_commandsReceived = 0;
+unsigned long long g_metersSent = 0;
+
+string jsonString(const string &s) {
+	string json = "\"";
+	for (size_t n = 0; n < s.length(); n++) {
+		if (s[n] == '"' || s[n] == '\\') {
+			json += '\\';
+		}
+		json += s[n];
+	}
+	return json + "\"";
+}
+
+// set values arrive unquoted, numbers and booleans stay as they are
+string jsonValue(const string &s) {
+	if (s == "true" || s == "false") {
+		return s;
+	}
+	char *end = NULL;
+	strtod(s.c_str(), &end);
+	if (!s.empty() && end && *end == 0) {
+		return s;
+	}
+	return jsonString(s);
+}
+
+void addProperty(const string &path, const string &value) {
+	g_properties[path] = value;
+}
+
+void addMeters(const string &root) {
+	for (int m = 0; m < 2; m++) {
+		addProperty(root + "/meters/" + to_string(m) + "/MeterLevel", "-144.0");
+		addProperty(root + "/meters/" + to_string(m) + "/MeterClip", "false");
+	}
+}
+
+void buildModel() {
+	addProperty("/Session", jsonString("Mock Session"));
+	addProperty("/IOMapPreset", jsonString("Mock Preset"));
+	addProperty("/PostFaderMetering", "false");
+
+	int sends = g_options.cues + 2; // cues and 2 aux sends
+
+	for (int d = 0; d < g_options.devices; d++) {
+		string dev = "/devices/" + to_string(d);
+		addProperty(dev + "/Name", jsonString("Mock Apollo " + to_string(d)));
+		addProperty(dev + "/DeviceOnline", "true");
+		if (d == 0) {
+			addProperty(dev + "/CueBusCount", to_string(g_options.cues));
+		}
+
+		for (int i = 0; i < g_options.inputs; i++) {
+			string input = dev + "/inputs/" + to_string(i);
+			addProperty(input + "/Name", jsonString("In " + to_string(d) + "." + to_string(i + 1)));
+			addProperty(input + "/StereoName", jsonString("In " + to_string(d) + "." + to_string(i + 1) + "/" + to_string(i + 2)));
+			addProperty(input + "/Stereo", "false");
+			addProperty(input + "/ChannelHidden", "false");
+			addProperty(input + "/EnabledByUser", "true");
+			addProperty(input + "/Active", "true");
+			addProperty(input + "/Mute", "false");
+			addProperty(input + "/Solo", "false");
+			addProperty(input + "/FaderLevel", "0.0");
+			addProperty(input + "/Pan", "0.0");
+			addProperty(input + "/Pan2", "0.0");
+			addMeters(input);
+			for (int s = 0; s < sends; s++) {
+				string send = input + "/sends/" + to_string(s);
+				addProperty(send + "/Gain", "-144.0");
+				addProperty(send + "/Pan", "0.0");
+				addProperty(send + "/Bypass", "false");
+				addMeters(send);
+			}
+		}
+
+		if (d == 0) {
+			for (int a = 0; a < g_options.auxs; a++) {
+				string aux = dev + "/auxs/" + to_string(a);
+				addProperty(aux + "/Name", jsonString("AUX " + to_string(a + 1)));
+				addProperty(aux + "/Mute", "false");
+				addProperty(aux + "/FaderLevel", "0.0");
+				addProperty(aux + "/SendPostFader", "false");
+				addMeters(aux);
+				for (int s = 0; s < g_options.cues; s++) {
+					string send = aux + "/sends/" + to_string(s);
+					addProperty(send + "/Gain", "-144.0");
+					addProperty(send + "/Bypass", "false");
+					addMeters(send);
+				}
+			}
+
+			string output = dev + "/outputs/0";
+			addProperty(output + "/Name", jsonString("MONITOR"));
+			addProperty(output + "/Mute", "false");
+			addProperty(output + "/CRMonitorLevel", "-20.0");
+			addMeters(output);
+		}
+	}
+}
+
+// strips the trailing slash and /value the client puts behind property paths
+string normalizePath(string path) {
+	while (path.length() > 1 && path.back() == '/') {
+		path.pop_back();
+	}
+	if (path.length() > 6 && path.compare(path.length() - 6, 6, "/value") == 0) {
+		path.erase(path.length() - 6);
+	}
+	return path;
+}
+
+bool getChildren(const string &path, vector<string> &children) {
+	string prefix = path == "/" ? "/" : path + "/";
+	bool found = false;
+	for (map<string, string>::iterator it = g_properties.lower_bound(prefix); it != g_properties.end(); ++it) {
+		if (it->first.compare(0, prefix.length(), prefix) != 0) {
+			break;
+		}
+		found = true;
+		size_t end = it->first.find('/', prefix.length());
+		string child = it->first.substr(prefix.length(), end == string::npos ? string::npos : end - prefix.length());
+		if (children.empty() || children.back() != child) {
+			children.push_back(child);
+		}
+	}
+	// ids in numeric order like Console lists them
+	sort(children.begin(), children.end(), [](const string &a, const string &b) {
+		return a.length() != b.length() ? a.length() < b.length() : a < b;
+	});
+	return found;
+}
+
+void watchWritable(MockClient *client, bool writable) {
+	if (client->waitsWritable == writable) {
+		return;
+	}
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN | (writable ? (uint32_t)EPOLLOUT : 0u);
+	ev.data.fd = client->sock;
+	epoll_ctl(g_epoll, EPOLL_CTL_MOD, client->sock, &ev);
+	client->waitsWritable = writable;
+}
+
+void closeClient(MockClient *client) {
+	printf("client %d disconnected\n", client->sock);
+	epoll_ctl(g_epoll, EPOLL_CTL_DEL, client->sock, NULL);
+	close(client->sock);
+	g_clients.erase(client->sock);
+	delete client;
+}
+
+bool flushClient(MockClient *client) {
+	while (!client->out.empty()) {
+		ssize_t sent = ::send(client->sock, client->out.data(), client->out.length(), MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				watchWritable(client, true);
+				return true;
+			}
+			if (errno == EINTR) {
+				continue;
+			}
+			return false;
+		}
+		client->out.erase(0, (size_t)sent);
+	}
+	watchWritable(client, false);
+	return true;
+}
+
+void sendFrame(MockClient *client, const string &json) {
+	if (g_options.verbose) {
+		printf("%d <- %s\n", client->sock, json.c_str());
+	}
+	client->out += json;
+	client->out += '\0';
+	g_framesSent++;
+	g_bytesSent += json.length() + 1;
+}
+
+void sendValue(MockClient *client, const string &path, const string &value) {
+	sendFrame(client, "{\"path\":\"" + path + "/value\",\"data\":" + value + "}");
+}
+
+void sendError(MockClient *client, const string &path, const string &error) {
+	sendFrame(client, "{\"path\":\"" + path + "\",\"error\":" + jsonString(error) + "}");
+}
+
+void onCommand(MockClient *client, const string &command) {
+	g_commandsReceived++;
+	if (g_options.verbose) {
+		printf("%d -> %s\n", client->sock, command.c_str());
+	}
+
+	size_t space = command.find(' ');
+	if (space == string::npos) {
+		sendError(client, "", "invalid command: " + command);
+		return;
+	}
+	string verb = command.substr(0, space);
+	string rest = command.substr(space + 1);
+	string value;
+	if (verb == "set") {
+		size_t valueSpace = rest.find(' ');
+		if (valueSpace != string::npos) {
+			value = rest.substr(valueSpace + 1);
+			rest = rest.substr(0, valueSpace);
+		}
+	}
+	string path = normalizePath(rest);
+
+	map<string, string>::iterator property = g_properties.find(path);
+
+	if (verb == "get") {
+		if (property != g_properties.end()) {
+			sendFrame(client, "{\"path\":\"" + path + "\",\"data\":" + property->second + "}");
+			return;
+		}
+		vector<string> children;
+		if (!getChildren(path, children)) {
+			sendError(client, path, "not found");
+			return;
+		}
+		string json = "{\"path\":\"" + path + "\",\"data\":{\"children\":{";
+		for (size_t n = 0; n < children.size(); n++) {
+			json += (n ? ",\"" : "\"") + children[n] + "\":{}";
+		}
+		sendFrame(client, json + "}}}");
+	}
+	else if (verb == "subscribe") {
+		if (property == g_properties.end()) {
+			sendError(client, path, "not found");
+			return;
+		}
+		client->subscriptions.insert(path);
+		sendValue(client, path, property->second);
+	}
+	else if (verb == "unsubscribe") {
+		client->subscriptions.erase(path);
+	}
+	else if (verb == "set") {
+		if (property == g_properties.end()) {
+			sendError(client, path, "not found");
+			return;
+		}
+		property->second = jsonValue(value);
+		for (map<int, MockClient*>::iterator it = g_clients.begin(); it != g_clients.end(); ++it) {
+			if (it->second->subscriptions.count(path)) {
+				sendValue(it->second, path, property->second);
+			}
+		}
+	}
+	else {
+		sendError(client, path, "unknown command: " + verb);
+	}
+}
+
+void onReadable(MockClient *client) {
+	char buffer[MOCK_READ_SIZE];
+	for (;;) {
+		ssize_t received = recv(client->sock, buffer, sizeof(buffer), 0);
+		if (received == 0) {
+			closeClient(client);
+			return;
+		}
+		if (received < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				break;
+			}
+			closeClient(client);
+			return;
+		}
+		client->in.append(buffer, (size_t)received);
+	}
+
+	size_t start = 0;
+	size_t end;
+	while ((end = client->in.find('\0', start)) != string::npos) {
+		if (end > start) {
+			onCommand(client, client->in.substr(start, end - start));
+		}
+		start = end + 1;
+	}
+	client->in.erase(0, start);
+}
+
+// a slowly moving level per meter, different for every path
+void sendMeters(double t) {
+	for (map<int, MockClient*>::iterator it = g_clients.begin(); it != g_clients.end(); ++it) {
+		MockClient *client = it->second;
+		for (set<string>::iterator itS = client->subscriptions.begin(); itS != client->subscriptions.end(); ++itS) {
+			const string &path = *itS;
+			if (path.length() < 11 || path.compare(path.length() - 11, 11, "/MeterLevel") != 0) {
+				continue;
+			}
+			double phase = (double)(hash<string>()(path) % 1000) / 1000.0 * 2.0 * M_PI;
+			double db = -30.0 + 27.0 * sin(t * 2.0 + phase);
+			char value[32];
+			snprintf(value, sizeof(value), "%.2f", db);
+			sendValue(client, path, value);
+			g_metersSent++;
+		}
+	}
+	for (map<int, MockClient*>::iterator it = g_clients.begin(); it != g_clients.end();) {
+		MockClient *client = (it++)->second;
+		if (client->out.length() > MOCK_MAX_PENDING) {
+			printf("client %d can't keep up, dropped\n", client->sock);
+			closeClient(client);
+		}
+		else if (!flushClient(client)) {
+			closeClient(client);
+		}
+	}
+}
+
+int createTimer(int interval_ms) {
+	int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+	if (timer == -1) {
+		return -1;
+	}
+	struct itimerspec spec;
+	spec.it_interval.tv_sec = interval_ms / 1000;
+	spec.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+	spec.it_value = spec.it_interval;
+	timerfd_settime(timer, 0, &spec, NULL);
+	return timer;
+}
+
+void onSignal(int) {
+	g_running = false;
+}
+
+void printUsage(const char *name) {
+	printf("usage: %s [options]\n", name);
+	printf("  --port n          tcp port (4710)\n");
+	printf("  --devices n       number of devices (1)\n");
+	printf("  --inputs n        inputs per device (16)\n");
+	printf("  --auxs n          aux busses (2)\n");
+	printf("  --cues n          cue busses, CueBusCount (2)\n");
+	printf("  --meter-rate n    meter updates per second, 0 = off (30)\n");
+	printf("  --verbose         print all frames\n");
+}
+
+int main(int argc, char *argv[]) {
+	g_options.port = 4710;
+	g_options.devices = 1;
+	g_options.inputs = 16;
+	g_options.auxs = 2;
+	g_options.cues = 2;
+	g_options.meterRate = 30;
+	g_options.verbose = false;
+
+	for (int n = 1; n < argc; n++) {
+		string arg = argv[n];
+		int *option = NULL;
+		if (arg == "--port") option = &g_options.port;
+		else if (arg == "--devices") option = &g_options.devices;
+		else if (arg == "--inputs") option = &g_options.inputs;
+		else if (arg == "--auxs") option = &g_options.auxs;
+		else if (arg == "--cues") option = &g_options.cues;
+		else if (arg == "--meter-rate") option = &g_options.meterRate;
+		else if (arg == "--verbose") {
+			g_options.verbose = true;
+			continue;
+		}
+		else {
+			printUsage(argv[0]);
+			return arg == "--help" ? 0 : 1;
+		}
+		if (++n >= argc) {
+			printUsage(argv[0]);
+			return 1;
+		}
+		*option = max(0, atoi(argv[n]));
+	}
+
+	buildModel();
+
+	int listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+	int one = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+	struct sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((uint16_t)g_options.port);
+	addr.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(listener, 16) != 0) {
+		printf("can't listen on port %d: %s\n", g_options.port, strerror(errno));
+		return 1;
+	}
+
+	g_epoll = epoll_create1(0);
+	int meterTimer = g_options.meterRate > 0 ? createTimer(max(1, 1000 / g_options.meterRate)) : -1;
+	int statsTimer = createTimer(1000);
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.fd = listener;
+	epoll_ctl(g_epoll, EPOLL_CTL_ADD, listener, &ev);
+	if (meterTimer != -1) {
+		ev.data.fd = meterTimer;
+		epoll_ctl(g_epoll, EPOLL_CTL_ADD, meterTimer, &ev);
+	}
+	ev.data.fd = statsTimer;
+	epoll_ctl(g_epoll, EPOLL_CTL_ADD, statsTimer, &ev);
+
+	signal(SIGINT, onSignal);
+	signal(SIGTERM, onSignal);
+
+	printf("mock server on port %d: %d devices, %d inputs each, %d auxs, %d cues, %zu properties, meters at %d Hz\n",
+		g_options.port, g_options.devices, g_options.inputs, g_options.auxs, g_options.cues, g_properties.size(), g_options.meterRate);
+
+	chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+	unsigned long long lastFrames = 0, lastBytes = 0, lastCommands = 0, lastMeters = 0;
+
+	struct epoll_event events[MOCK_MAX_EVENTS];
+	while (g_running) {
+		int count = epoll_wait(g_epoll, events, MOCK_MAX_EVENTS, -1);
+		if (count < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			break;
+		}
+		for (int n = 0; n < count; n++) {
+			int fd = events[n].data.fd;
+			if (fd == listener) {
+				int sock;
+				while ((sock = accept4(listener, NULL, NULL, SOCK_NONBLOCK)) != -1) {
+					setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+					MockClient *client = new MockClient;
+					client->sock = sock;
+					client->waitsWritable = false;
+					g_clients[sock] = client;
+					ev.events = EPOLLIN;
+					ev.data.fd = sock;
+					epoll_ctl(g_epoll, EPOLL_CTL_ADD, sock, &ev);
+					printf("client %d connected\n", sock);
+				}
+			}
+			else if (fd == meterTimer || fd == statsTimer) {
+				uint64_t expirations;
+				if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+					continue;
+				}
+				if (fd == meterTimer) {
+					sendMeters(chrono::duration<double>(chrono::steady_clock::now() - startTime).count());
+				}
+				else if (g_framesSent != lastFrames || g_commandsReceived != lastCommands) {
+					printf("%zu clients: %llu commands/s, %llu frames/s (%llu meters), %llu kB/s\n", g_clients.size(),
+						g_commandsReceived - lastCommands, g_framesSent - lastFrames, g_metersSent - lastMeters, (g_bytesSent - lastBytes) / 1024);
+					lastFrames = g_framesSent;
+					lastBytes = g_bytesSent;
+					lastCommands = g_commandsReceived;
+					lastMeters = g_metersSent;
+				}
+			}
+			else {
+				map<int, MockClient*>::iterator it = g_clients.find(fd);
+				if (it == g_clients.end()) {
+					continue;
+				}
+				MockClient *client = it->second;
+				if (events[n].events & (EPOLLERR | EPOLLHUP)) {
+					closeClient(client);
+					continue;
+				}
+				if (events[n].events & EPOLLIN) {
+					onReadable(client);
+					if (g_clients.find(fd) == g_clients.end()) {
+						continue;
+					}
+				}
+				if (!flushClient(client)) {
+					closeClient(client);
+				}
+			}
+		}
+	}
+
+	while (!g_clients.empty()) {
+		closeClient(g_clients.begin()->second);
+	}
+	close(listener);
+	close(g_epoll);
+	printf("%llu commands received, %llu frames and %llu bytes sent\n", g_commandsReceived, g_framesSent, g_bytesSent);
+	return 0;
+}
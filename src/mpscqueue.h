@@ -0,0 +1,109 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MPSCQUEUE_
+#define _MPSCQUEUE_
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+using namespace std;
+
+// Bounded lock-free queue for many producers and a single consumer.
+// Every cell carries a sequence number telling whether it is free for the
+// producer of a certain position or filled for the consumer (D. Vyukov).
+// The capacity is rounded up to a power of 2.
+template <typename T>
+class MPSCQueue
+{
+private:
+	struct Cell {
+		atomic<size_t> sequence;
+		T data;
+	};
+	Cell *cells;
+	size_t mask;
+	alignas(64) atomic<size_t> enqueuePos;
+	alignas(64) size_t dequeuePos;
+public:
+	MPSCQueue(size_t capacity) {
+		size_t size = 2;
+		while (size < capacity) {
+			size *= 2;
+		}
+		this->cells = new Cell[size];
+		this->mask = size - 1;
+		for (size_t n = 0; n < size; n++) {
+			this->cells[n].sequence.store(n, memory_order_relaxed);
+		}
+		this->enqueuePos.store(0, memory_order_relaxed);
+		this->dequeuePos = 0;
+	}
+
+	~MPSCQueue() {
+		delete[] this->cells;
+	}
+
+	MPSCQueue(const MPSCQueue&) = delete;
+	MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+	// any thread; returns false if the queue is full
+	bool push(T &&data) {
+		Cell *cell;
+		size_t pos = this->enqueuePos.load(memory_order_relaxed);
+		for (;;) {
+			cell = &this->cells[pos & this->mask];
+			size_t seq = cell->sequence.load(memory_order_acquire);
+			intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+			if (dif == 0) {
+				if (this->enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+					break;
+				}
+			}
+			else if (dif < 0) {
+				return false;
+			}
+			else {
+				pos = this->enqueuePos.load(memory_order_relaxed);
+			}
+		}
+		cell->data = std::move(data);
+		cell->sequence.store(pos + 1, memory_order_release);
+		return true;
+	}
+
+	// consumer thread only; returns false if the queue is empty
+	bool pop(T &data) {
+		Cell *cell = &this->cells[this->dequeuePos & this->mask];
+		size_t seq = cell->sequence.load(memory_order_acquire);
+		if ((intptr_t)seq - (intptr_t)(this->dequeuePos + 1) < 0) {
+			return false;
+		}
+		data = std::move(cell->data);
+		cell->sequence.store(this->dequeuePos + this->mask + 1, memory_order_release);
+		this->dequeuePos++;
+		return true;
+	}
+};
+
+#endif
@@ -0,0 +1,32 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _NETMESSAGE_
+#define _NETMESSAGE_
+
+// messages to the MessageCallback of a TCPClient (and of a replayed recording)
+#define MSG_CLIENT_CONNECTED		1
+#define MSG_CLIENT_DISCONNECTED		2
+#define MSG_CLIENT_CONNECTION_LOST	3
+#define MSG_TEXT					4
+#define MSG_TEXT_BATCH				5 // all complete frames of one read, each terminated by NUL, see FrameBuffer::splitBatch()
+
+#endif
@@ -20,6 +20,7 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 */
 #include "network_linux.h"
 #include "gfx2d_sdl.h"
+#include <future>
 
 string TCPClient::getComputerNameByIP(const string &ip) {
 
@@ -39,12 +40,10 @@ string TCPClient::getComputerNameByIP(const string &ip) {
 	return ip;
 }
 
-bool TCPClient::getClientIPs(vector<string>& ips)
+bool TCPClient::getClientInterfaces(vector<IPv4Interface>& interfaces)
 {
 	struct ifaddrs * ifAddrStruct=NULL;
     struct ifaddrs * ifa=NULL;
-    void * tmpAddrPtr=NULL;
-	bool result = true;
 
     if(getifaddrs(&ifAddrStruct) == 0)
 	{
@@ -55,156 +54,531 @@ bool TCPClient::getClientIPs(vector<string>& ips)
 			}
 			if (ifa->ifa_addr->sa_family == AF_INET)
 			{
-				tmpAddrPtr=&((struct sockaddr_in *)ifa->ifa_addr)->sin_addr;
-				char addressBuffer[INET_ADDRSTRLEN];
-				if (inet_ntop(AF_INET, tmpAddrPtr, addressBuffer, INET_ADDRSTRLEN)) {
-					ips.push_back(string(addressBuffer));
+				IPv4Interface iface;
+				iface.address = ntohl(((struct sockaddr_in *)ifa->ifa_addr)->sin_addr.s_addr);
+				if (ifa->ifa_netmask) {
+					iface.netmask = ntohl(((struct sockaddr_in *)ifa->ifa_netmask)->sin_addr.s_addr);
 				}
 				else {
-					result = false;
+					iface.netmask = 0xFFFFFF00;
 				}
+				iface.ip = addressToString(iface.address);
+				interfaces.push_back(iface);
 			}
-		/*	else if (ifa->ifa_addr->sa_family == AF_INET6)
-			{
-				tmpAddrPtr=&((struct sockaddr_in6 *)ifa->ifa_addr)->sin6_addr;
-				char addressBuffer[INET6_ADDRSTRLEN];
-				inet_ntop(AF_INET6, tmpAddrPtr, addressBuffer, INET6_ADDRSTRLEN);
-				
-				MessageCallback(addressBuffer);
-			}*/
 		}
 		if (ifAddrStruct) {
 			freeifaddrs(ifAddrStruct);
 		}
 
-		return result;
+		return true;
 	}
 	return false;
 }
 
+string TCPClient::addressToString(uint32_t address) {
+	struct in_addr addr;
+	addr.s_addr = htonl(address);
+	char addressBuffer[INET_ADDRSTRLEN];
+	if (inet_ntop(AF_INET, &addr, addressBuffer, INET_ADDRSTRLEN)) {
+		return string(addressBuffer);
+	}
+	return "";
+}
 
-bool TCPClient::lookUpServers(const string& ipMask, int start, int end, const string& port, int timeout, vector<string>& servers) {
+bool TCPClient::stringToAddress(const string& ip, uint32_t& address) {
+	struct in_addr addr;
+	if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
+		return false;
+	}
+	address = ntohl(addr.s_addr);
+	return true;
+}
 
-	int range = end - start;
+string TCPClient::resolveHost(const string& host) {
+	struct addrinfo hints, * result;
+	memset(&hints, 0, sizeof(struct addrinfo));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
 
-	if (range < 1) {
-		return false;
+	if (getaddrinfo(host.c_str(), NULL, &hints, &result) != 0) {
+		throw invalid_argument("Error on resolving hostname on " + host);
+	}
+	if (!result) {
+		throw invalid_argument("Error on resolving hostname (result == NULL) on " + host);
 	}
 
-	struct pollfd* fds = new struct pollfd[range];
-	if (!fds) {
-		return false;
+	string ip = addressToString(ntohl(((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr));
+	freeaddrinfo(result);
+
+	if (ip.empty()) {
+		throw invalid_argument("Error on resolving hostname on " + host);
 	}
+	return ip;
+}
 
-	memset(fds, 0, sizeof(struct pollfd) * range);
+bool TCPClient::initNetwork() {
+	return NetworkReactor::start();
+}
 
-	for (int n = 0; n < range; n++) {
-		string ip = ipMask + to_string(n + start);
-		try {
-			int sock = connectNonBlock(ip, port);
-			if (sock) {
-				fds[n].fd = sock;
-				fds[n].events = POLLOUT;
-			}
-			else {
-				fds[n].fd = -1;
+void TCPClient::cancelNetwork() {
+	NetworkReactor::cancel();
+}
+
+void TCPClient::releaseNetwork() {
+	NetworkReactor::stop();
+}
+
+// runs on the reactor thread only
+struct ServerScanner {
+	NetworkReactor *reactor;
+	vector<uint32_t> addresses;
+	size_t next;
+	size_t finished;
+	string port;
+	int timeout;
+	int maxProbes;
+	int probesPerSecond;
+	int active;
+	double tokens;
+	double burst;
+	unsigned long long refilled;
+	uint64_t refillTimerId;
+	uint64_t stopId;
+	map<uint64_t, int> probeSocks; // io id -> socket of the probes waiting for an answer
+	bool completed;
+	vector<string> found;
+	void (*ServerFound)(const string& ip, unsigned int rtt);
+	void (*ScanProgress)(unsigned int probed);
+	promise<void> done;
+};
+
+struct ServerProbe {
+	int sock;
+	uint64_t ioId;
+	uint64_t timerId;
+	string ip;
+	chrono::steady_clock::time_point started;
+};
+
+static void launchServerProbes(shared_ptr<ServerScanner> scanner);
+
+static void endServerProbe(shared_ptr<ServerScanner> scanner, shared_ptr<ServerProbe> probe, bool connected) {
+	scanner->probeSocks.erase(probe->ioId);
+	scanner->reactor->remove(probe->ioId);
+	scanner->reactor->cancelTimer(probe->timerId);
+	close(probe->sock);
+	scanner->active--;
+	scanner->finished++;
+
+	if (connected) {
+		scanner->found.push_back(probe->ip);
+		if (scanner->ServerFound) {
+			unsigned int rtt = (unsigned int)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - probe->started).count();
+			scanner->ServerFound(probe->ip, rtt);
+		}
+	}
+	if (scanner->ScanProgress) {
+		scanner->ScanProgress(1);
+	}
+
+	launchServerProbes(scanner);
+}
+
+static void launchServerProbes(shared_ptr<ServerScanner> scanner) {
+	NetworkReactor *reactor = scanner->reactor;
+
+	// token bucket, allows bursts of TCP_SCAN_BURST
+	if (scanner->probesPerSecond > 0) {
+		unsigned long long now = GetTickCount64();
+		scanner->tokens = min(scanner->burst, scanner->tokens + (double)(now - scanner->refilled) * scanner->probesPerSecond / 1000.0);
+		scanner->refilled = now;
+	}
+
+	while (scanner->active < scanner->maxProbes && scanner->next < scanner->addresses.size()) {
+		if (scanner->probesPerSecond > 0 && scanner->tokens < 1.0) {
+			if (!scanner->refillTimerId) {
+				unsigned int wait = (unsigned int)((1.0 - scanner->tokens) * 1000.0 / scanner->probesPerSecond) + 1;
+				scanner->refillTimerId = reactor->addTimer(wait, [scanner] {
+					scanner->refillTimerId = 0;
+					launchServerProbes(scanner);
+				});
 			}
+			break;
+		}
+		scanner->tokens -= 1.0;
+
+		shared_ptr<ServerProbe> probe = make_shared<ServerProbe>();
+		probe->ip = TCPClient::addressToString(scanner->addresses[scanner->next]);
+		probe->sock = -1;
+		probe->timerId = 0;
+		probe->started = chrono::steady_clock::now();
+		scanner->next++;
+
+		try {
+			probe->sock = TCPClient::connectNonBlock(probe->ip, scanner->port);
 		}
 		catch (invalid_argument&) {
 		}
-	}
 
-	unsigned long long time = GetTickCount64();
-	int n = 0;
-	while (n < 254 && time + timeout > GetTickCount64()) {
-		int res = poll(fds, range, timeout / 10);
-		if (res < 1) {
-			break;
+		if (probe->sock != -1) {
+			probe->ioId = reactor->add(probe->sock, EPOLLOUT, [scanner, probe](uint32_t events) {
+				endServerProbe(scanner, probe, NetworkReactor::isConnected(probe->sock, events));
+			});
+			if (!probe->ioId) {
+				close(probe->sock);
+				probe->sock = -1;
+			}
 		}
-		else {
-			for (int i = 0; i < range; i++) {
-				if (fds[i].revents == POLLOUT) {
-					close(fds[i].fd);
-					fds[i].fd = -1;
-					servers.push_back(ipMask + to_string(i + start));
-					n++;
-				}
-				else if (fds[i].revents == POLLERR || fds[i].revents == POLLHUP || fds[i].revents == POLLNVAL) {
-					close(fds[i].fd);
-					fds[i].fd = -1;
-					n++;
-				}
+		if (probe->sock == -1) {
+			scanner->finished++;
+			if (scanner->ScanProgress) {
+				scanner->ScanProgress(1);
 			}
+			continue;
 		}
+
+		probe->timerId = reactor->addTimer(scanner->timeout, [scanner, probe] {
+			endServerProbe(scanner, probe, false);
+		});
+		scanner->probeSocks.insert({ probe->ioId, probe->sock });
+		scanner->active++;
+	}
+
+	if (scanner->finished == scanner->addresses.size() && !scanner->completed) {
+		scanner->completed = true;
+		reactor->removeStopHandler(scanner->stopId);
+		scanner->done.set_value();
+	}
+}
+
+// the reactor stops while probing, the caller gets the servers found so far
+static void stopServerProbes(shared_ptr<ServerScanner> scanner) {
+	for (map<uint64_t, int>::iterator it = scanner->probeSocks.begin(); it != scanner->probeSocks.end(); ++it) {
+		scanner->reactor->remove(it->first);
+		close(it->second);
+	}
+	scanner->probeSocks.clear();
+	scanner->reactor->cancelTimer(scanner->refillTimerId);
+	if (!scanner->completed) {
+		scanner->completed = true;
+		scanner->done.set_value();
+	}
+}
+
+bool TCPClient::lookUpServers(uint32_t first, uint32_t count, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+	void (*ServerFound)(const string& ip, unsigned int rtt), void (*ScanProgress)(unsigned int probed)) {
+
+	vector<uint32_t> addresses(count);
+	for (uint32_t n = 0; n < count; n++) {
+		addresses[n] = first + n;
+	}
+	return lookUpServers(addresses, port, timeout, maxProbes, probesPerSecond, servers, ServerFound, ScanProgress);
+}
+
+bool TCPClient::lookUpServers(const vector<uint32_t>& addresses, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+	void (*ServerFound)(const string& ip, unsigned int rtt), void (*ScanProgress)(unsigned int probed)) {
+
+	if (addresses.empty()) {
+		return false;
+	}
+
+	NetworkReactor *reactor = NetworkReactor::get();
+	if (!reactor) {
+		return false;
 	}
-	if (fds) {
-		delete[] fds;
-		fds = NULL;
+
+	shared_ptr<ServerScanner> scanner = make_shared<ServerScanner>();
+	scanner->reactor = reactor;
+	scanner->addresses = addresses;
+	scanner->next = 0;
+	scanner->finished = 0;
+	scanner->port = port;
+	scanner->timeout = timeout;
+	scanner->maxProbes = max(maxProbes, 1);
+	scanner->probesPerSecond = max(probesPerSecond, 0);
+	scanner->active = 0;
+	scanner->burst = max(1.0, (double)scanner->probesPerSecond * TCP_SCAN_BURST / 1000.0);
+	scanner->tokens = scanner->burst;
+	scanner->refilled = GetTickCount64();
+	scanner->refillTimerId = 0;
+	scanner->stopId = 0;
+	scanner->completed = false;
+	scanner->ServerFound = ServerFound;
+	scanner->ScanProgress = ScanProgress;
+
+	future<void> result = scanner->done.get_future();
+
+	// the probes belong to the reactor until all of them answered or timed out
+	if (!reactor->post([scanner] {
+		scanner->stopId = scanner->reactor->addStopHandler([scanner] {
+			stopServerProbes(scanner);
+		});
+		launchServerProbes(scanner);
+	})) {
+		return false;
 	}
+
+	result.wait();
+
+	servers.insert(servers.end(), scanner->found.begin(), scanner->found.end());
 	return true;
 }
 
+TCPSocketProfile TCPClient::socketProfile = { true, false, 0, 0, 0, 0, 0, 0 };
+
 TCPClient::TCPClient() {
 	this->MessageCallback = NULL;
-	this->receiveThreadHandle = NULL;
-	this->receiveThreadIsRunning = false;
+	this->reactor = NULL;
+	this->reactorId = 0;
+	this->waitsWritable = false;
+	this->sendSignaled = false;
+	this->connectionLost = false;
+	this->lostReported = false;
 	this->sock = 0;
+	memset(&this->sendStats, 0, sizeof(TCPSendStats));
+}
+
+TCPClient::TCPClient(const string &host, const string &port, void (*MessageCallback)(int, string_view), int timeout) : TCPClient() {
+
+	this->MessageCallback = MessageCallback;
+
+	this->reactor = NetworkReactor::get();
+	if (!this->reactor) {
+		throw invalid_argument("Network reactor not running");
+	}
+
+	this->sock = this->connectNonBlock(host, port, &socketProfile); // throws exception
+
+	if (!this->reactor->waitWritable(this->sock, timeout)) {
+		close(this->sock);
+		this->sock = 0;
+		throw invalid_argument("Error on connecting (timeout) " + host + ":" + port);
+	}
+
+	this->start(); // throws exception
 }
 
-TCPClient::TCPClient(const string &host, const string &port, void (*MessageCallback)(int,const string&), int timeout) : TCPClient() {
+TCPClient::TCPClient(int sock, void (*MessageCallback)(int, string_view)) : TCPClient() {
 
 	this->MessageCallback = MessageCallback;
 
-	this->sock = this->connectNonBlock(host, port); // throws exception
+	this->reactor = NetworkReactor::get();
+	if (!this->reactor) {
+		close(sock);
+		throw invalid_argument("Network reactor not running");
+	}
 
-	struct pollfd fds[1];
-	memset(fds, 0, sizeof(struct pollfd));
-	fds[0].fd = this->sock;
-	fds[0].events = POLLOUT;
-	int res = poll(fds, 1, timeout);
-	if (res < 1 || fds[0].revents != POLLOUT) {
+	this->sock = sock;
+	this->start(); // throws exception
+}
+
+void TCPClient::start() {
+	// the socket stays non-blocking, it is only read and written on the reactor thread
+	this->reactor->call([this] {
+		this->reactorId = this->reactor->add(this->sock, EPOLLIN, [this](uint32_t events) {
+			this->onEvents(events);
+		});
+	});
+	if (!this->reactorId) {
+		shutdown(this->sock, SHUT_RDWR);
 		close(this->sock);
 		this->sock = 0;
-		throw invalid_argument("Error on poll (" + to_string(res) + ") " + host + ":" + port);
+		throw invalid_argument("Error on adding socket to reactor");
 	}
 
-	setBlock(this->sock, true);
+	void (*callback)(int, string_view) = this->MessageCallback;
+	if (callback) {
+		callback(MSG_CLIENT_CONNECTED, "");
+	}
+}
 
-	if (this->MessageCallback) {
-		this->receiveThreadHandle = SDL_CreateThread(receiveThread, "ReceiveThread",(void*)this);
-		if (this->receiveThreadHandle) {
-			this->MessageCallback(MSG_CLIENT_CONNECTED, "");
+// runs on the reactor thread only
+struct ConnectRace {
+	NetworkReactor *reactor;
+	string handshake;
+	vector<int> socks;
+	vector<uint64_t> ids;
+	vector<TCPRaceResult> results;
+	chrono::steady_clock::time_point started;
+	int remaining;
+	int winner;
+	uint64_t timerId;
+	uint64_t stopId;
+	bool completed;
+	promise<void> done;
+};
+
+static void finishConnectRace(shared_ptr<ConnectRace> race) {
+	if (race->completed) {
+		return;
+	}
+	race->completed = true;
+	race->reactor->cancelTimer(race->timerId);
+	race->reactor->removeStopHandler(race->stopId);
+
+	// the winner's socket is handed over, all others are closed
+	for (size_t n = 0; n < race->socks.size(); n++) {
+		if (race->ids[n]) {
+			race->reactor->remove(race->ids[n]);
+			race->ids[n] = 0;
 		}
-		else {
-			shutdown(this->sock, SHUT_RDWR);
-			close(this->sock);
-			this->sock = 0;
-			throw invalid_argument("Error on creating thread");
+		if ((int)n != race->winner && race->socks[n] != -1) {
+			close(race->socks[n]);
+			race->socks[n] = -1;
 		}
 	}
+	race->done.set_value();
+}
+
+static void dropRaceCandidate(shared_ptr<ConnectRace> race, size_t n) {
+	race->reactor->remove(race->ids[n]);
+	race->ids[n] = 0;
+	close(race->socks[n]);
+	race->socks[n] = -1;
+	if (--race->remaining == 0) {
+		finishConnectRace(race);
+	}
+}
+
+static void onRaceCandidateEvents(shared_ptr<ConnectRace> race, size_t n, uint32_t events) {
+	long long elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - race->started).count();
+
+	if (race->results[n].connectTime == -1) {
+		if (!NetworkReactor::isConnected(race->socks[n], events)) {
+			dropRaceCandidate(race, n);
+			return;
+		}
+		race->results[n].connectTime = elapsed;
+
+		// the handshake is tiny, it fits into the empty socket buffer
+		ssize_t sent = ::send(race->socks[n], race->handshake.c_str(), race->handshake.length() + 1, MSG_NOSIGNAL);
+		if (sent != (ssize_t)race->handshake.length() + 1) {
+			dropRaceCandidate(race, n);
+			return;
+		}
+		race->reactor->modify(race->ids[n], EPOLLIN);
+		return;
+	}
+
+	// the first complete message is the answer, it is dropped since the winner asks again
+	char buffer[TCP_BUFFER_SIZE];
+	ssize_t bytes = read(race->socks[n], buffer, TCP_BUFFER_SIZE);
+	if (bytes > 0) {
+		if (memchr(buffer, 0, (size_t)bytes)) {
+			race->results[n].answerTime = elapsed;
+			race->winner = (int)n;
+			finishConnectRace(race);
+		}
+	}
+	else if (bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+		dropRaceCandidate(race, n);
+	}
+}
+
+TCPClient* TCPClient::race(const vector<string>& hosts, const string& port, void (*MessageCallback)(int, string_view), const string& handshake,
+	vector<TCPRaceResult>& results, int& winner, int timeout) {
+
+	NetworkReactor *reactor = NetworkReactor::get();
+	if (!reactor) {
+		throw invalid_argument("Network reactor not running");
+	}
+
+	shared_ptr<ConnectRace> race = make_shared<ConnectRace>();
+	race->reactor = reactor;
+	race->handshake = handshake;
+	race->socks.resize(hosts.size(), -1);
+	race->ids.resize(hosts.size(), 0);
+	race->results.resize(hosts.size());
+	race->started = chrono::steady_clock::now();
+	race->remaining = 0;
+	race->winner = -1;
+	race->timerId = 0;
+	race->stopId = 0;
+	race->completed = false;
+
+	for (size_t n = 0; n < hosts.size(); n++) {
+		race->results[n].host = hosts[n];
+		race->results[n].connectTime = -1;
+		race->results[n].answerTime = -1;
+		try {
+			race->socks[n] = connectNonBlock(hosts[n], port, &socketProfile);
+		}
+		catch (invalid_argument&) {
+		}
+	}
+
+	future<void> result = race->done.get_future();
+
+	bool posted = reactor->post([race, timeout] {
+		// without a winner if the reactor stops first
+		race->stopId = race->reactor->addStopHandler([race] {
+			finishConnectRace(race);
+		});
+		for (size_t n = 0; n < race->socks.size(); n++) {
+			if (race->socks[n] == -1) {
+				continue;
+			}
+			race->ids[n] = race->reactor->add(race->socks[n], EPOLLOUT, [race, n](uint32_t events) {
+				onRaceCandidateEvents(race, n, events);
+			});
+			if (race->ids[n]) {
+				race->remaining++;
+			}
+			else {
+				close(race->socks[n]);
+				race->socks[n] = -1;
+			}
+		}
+
+		if (race->remaining == 0) {
+			finishConnectRace(race);
+			return;
+		}
+		race->timerId = race->reactor->addTimer(timeout, [race] {
+			finishConnectRace(race);
+		});
+	});
+
+	if (!posted) {
+		for (size_t n = 0; n < race->socks.size(); n++) {
+			if (race->socks[n] != -1) {
+				close(race->socks[n]);
+			}
+		}
+		throw invalid_argument("Network reactor not running");
+	}
+
+	result.wait();
+
+	results = race->results;
+	winner = race->winner;
+	if (winner == -1) {
+		throw invalid_argument("No server answered");
+	}
+
+	return new TCPClient(race->socks[winner], MessageCallback); // throws exception
 }
 
 TCPClient::~TCPClient() {
 
+	// no handler runs after this returns
+	if (this->reactorId) {
+		this->reactor->call([this] {
+			this->reactor->remove(this->reactorId);
+		});
+		this->reactorId = 0;
+	}
+
 	if(this->sock) {
-		if (this->MessageCallback) {
-			this->MessageCallback(MSG_CLIENT_DISCONNECTED, "");
+		void (*callback)(int, string_view) = this->MessageCallback.exchange(NULL);
+		if (callback) {
+			callback(MSG_CLIENT_DISCONNECTED, "");
 		}
-		this->MessageCallback = NULL;
 		shutdown(this->sock, SHUT_RDWR);
 		close(this->sock);
 		this->sock=0;
 	}
-
-	unsigned long long timeout = GetTickCount64();
-	while (this->receiveThreadIsRunning) { // wait until thread is terminated
-		Sleep(250);
-		if (GetTickCount64() - timeout > 3000) { // call terminate thread after 3 sec
-			SDL_DetachThread(this->receiveThreadHandle);
-			this->receiveThreadIsRunning = false;
-			this->receiveThreadHandle = NULL;
-		}
-	}
 }
 
 
@@ -226,7 +600,75 @@ bool TCPClient::setBlock(int sock, bool block) {
 	return true;
 }
 
-int TCPClient::connectNonBlock(const string& host, const string& port) {
+void TCPClient::setSocketProfile(const TCPSocketProfile& profile) {
+	socketProfile = profile;
+}
+
+void TCPClient::applySocketProfile(int sock, const TCPSocketProfile& profile) {
+	// failing options are not fatal, getSocketInfo shows what is in effect
+	int val = profile.nodelay ? 1 : 0;
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &val, sizeof(val));
+
+	val = profile.keepalive ? 1 : 0;
+	setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &val, sizeof(val));
+	if (profile.keepalive) {
+		if (profile.keepalive_idle > 0) {
+			setsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &profile.keepalive_idle, sizeof(int));
+		}
+		if (profile.keepalive_interval > 0) {
+			setsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &profile.keepalive_interval, sizeof(int));
+		}
+		if (profile.keepalive_count > 0) {
+			setsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &profile.keepalive_count, sizeof(int));
+		}
+	}
+
+	// buffers have to be set before connect to take effect on the window scaling
+	if (profile.rcvbuf > 0) {
+		setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &profile.rcvbuf, sizeof(int));
+	}
+	if (profile.sndbuf > 0) {
+		setsockopt(sock, SOL_SOCKET, SO_SNDBUF, &profile.sndbuf, sizeof(int));
+	}
+
+	if (profile.dscp > 0) {
+		val = (profile.dscp & 0x3F) << 2;
+		setsockopt(sock, IPPROTO_IP, IP_TOS, &val, sizeof(val));
+	}
+}
+
+string TCPClient::getSocketInfo(int sock) {
+	int nodelay = 0, keepalive = 0, idle = 0, interval = 0, count = 0, rcvbuf = 0, sndbuf = 0, tos = 0;
+	socklen_t len = sizeof(int);
+	getsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, &len);
+	len = sizeof(int);
+	getsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, &keepalive, &len);
+	len = sizeof(int);
+	getsockopt(sock, IPPROTO_TCP, TCP_KEEPIDLE, &idle, &len);
+	len = sizeof(int);
+	getsockopt(sock, IPPROTO_TCP, TCP_KEEPINTVL, &interval, &len);
+	len = sizeof(int);
+	getsockopt(sock, IPPROTO_TCP, TCP_KEEPCNT, &count, &len);
+	len = sizeof(int);
+	getsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, &len);
+	len = sizeof(int);
+	getsockopt(sock, SOL_SOCKET, SO_SNDBUF, &sndbuf, &len);
+	len = sizeof(int);
+	getsockopt(sock, IPPROTO_IP, IP_TOS, &tos, &len);
+
+	string info = "nodelay " + to_string(nodelay) + ", keepalive " + to_string(keepalive);
+	if (keepalive) {
+		info += " (idle " + to_string(idle) + " s, interval " + to_string(interval) + " s, count " + to_string(count) + ")";
+	}
+	info += ", rcvbuf " + to_string(rcvbuf) + ", sndbuf " + to_string(sndbuf) + ", dscp " + to_string(tos >> 2);
+	return info;
+}
+
+string TCPClient::getSocketInfo() {
+	return getSocketInfo(this->sock);
+}
+
+int TCPClient::connectNonBlock(const string& host, const string& port, const TCPSocketProfile* profile) {
 	int sock = 0;
 	struct addrinfo hints, * result;
 	memset(&hints, 0, sizeof(struct addrinfo));
@@ -250,12 +692,18 @@ int TCPClient::connectNonBlock(const string& host, const string& port) {
 
 	if (!setBlock(sock, false)) {
 		freeaddrinfo(result);
+		close(sock);
 		throw invalid_argument("Error on setBlock");
 	}
 
+	if (profile) {
+		applySocketProfile(sock, *profile);
+	}
+
 	if (connect(sock, result->ai_addr, (int)result->ai_addrlen) == -1) {
 		if (errno != EINPROGRESS) {
 			freeaddrinfo(result);
+			close(sock);
 			throw invalid_argument("Error on connecting to " + host + ":" + port);
 		}
 	}
@@ -277,121 +725,142 @@ int TCPClient::connectNonBlock(const string& host, const string& port) {
 	return sock;
 }
 
-int SDLCALL TCPClient::receiveThread(void* param)
-{
-	TCPClient* tcpClient = (TCPClient*)param;
-	tcpClient->receiveThreadIsRunning = true;
-
-	char buffer[TCP_BUFFER_SIZE];
-	string completeMessage;
+void TCPClient::onEvents(uint32_t events) {
+	if (events & (EPOLLIN | EPOLLERR | EPOLLHUP)) {
+		this->onReadable();
+	}
+	if (!this->connectionLost && (events & (EPOLLOUT | REACTOR_NOTIFY))) {
+		this->flush();
+	}
+}
 
-	while (tcpClient->sock) {
-		ssize_t bytes = read(tcpClient->sock, buffer, TCP_BUFFER_SIZE);
+void TCPClient::onReadable() {
+	while (!this->connectionLost) {
+		size_t space = 0;
+		char* buffer = this->frameBuffer.prepareWrite(space);
+		ssize_t bytes = read(this->sock, buffer, space);
 
 		if (bytes > 0) {
-			size_t i = 0;
-			while (i < (size_t)bytes) {
-				size_t len = strnlen(&buffer[i], TCP_BUFFER_SIZE - i);
-				completeMessage += string(&buffer[i], len);
-
-				if (i + len >= (size_t)bytes) {
-					//message nicht komplett, warte auf weitere pakete
-				}
-				else {
-					//message komplett
-					if (tcpClient->MessageCallback) {
-						tcpClient->MessageCallback(MSG_TEXT, completeMessage);
-					}
-					completeMessage = "";
-				}
+			this->frameBuffer.commitWrite((size_t)bytes);
 
-				//suche nach weiteren messages im stream
-				i += strnlen(&buffer[i], TCP_BUFFER_SIZE - i) + 1;
+			string_view batch;
+			void (*callback)(int, string_view) = this->MessageCallback.load(memory_order_acquire);
+			if (this->frameBuffer.nextBatch(batch) && callback) {
+				callback(MSG_TEXT_BATCH, batch);
 			}
-		}
-		else/* if (bytes == -1)*/ {
-			if (tcpClient->MessageCallback) {
-				tcpClient->MessageCallback(MSG_CLIENT_CONNECTION_LOST, "");
+			if ((size_t)bytes < space) {
+				break; // drained, epoll reports the next data
 			}
+		}
+		else if (bytes == -1 && errno == EINTR) {
+			continue;
+		}
+		else if (bytes == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
 			break;
 		}
+		else {
+			this->reportConnectionLost();
+		}
 	}
+}
 
-	tcpClient->receiveThreadIsRunning = false;
+void TCPClient::reportConnectionLost() {
+	if (this->connectionLost.exchange(true)) {
+		return;
+	}
+	// stop polling the dead socket, it would be reported as readable forever
+	this->reactor->remove(this->reactorId);
 
-	return 0;
+	const std::lock_guard<std::mutex> lock(this->callbackMutex);
+	void (*callback)(int, string_view) = this->MessageCallback;
+	if (callback) {
+		callback(MSG_CLIENT_CONNECTION_LOST, "");
+	}
+	this->lostReported = true;
 }
 
-int TCPClient::receive(string &msg, int timeout) {
-	char buffer[TCP_BUFFER_SIZE];
-	msg = "";
-	
-	setBlock(this->sock, false);
-
-	int result = 0;
-	while (this->sock && !result) {
-
-		struct pollfd fds[1];
-		fds[0].fd = this->sock;
-		fds[0].events = POLLIN;
-		int res = poll(fds, 1, timeout);
-		if (res < 1 || fds[0].revents != POLLIN) {
-			result = -1;
-			break;
-		}
+void TCPClient::setMessageCallback(void (*MessageCallback)(int, string_view)) {
+	const std::lock_guard<std::mutex> lock(this->callbackMutex);
+	this->MessageCallback = MessageCallback;
+	if (this->lostReported && MessageCallback) {
+		MessageCallback(MSG_CLIENT_CONNECTION_LOST, "");
+	}
+}
 
-		ssize_t bytes = read(this->sock, buffer, TCP_BUFFER_SIZE);
+void TCPClient::flush() {
+	this->sendSignaled = false;
+	this->sendQueue.collect();
+
+	while (this->sendQueue.isPending()) {
+		// one buffer per message including its terminating NUL
+		size_t first, offset;
+		const vector<string> &pending = this->sendQueue.getPending(first, offset);
+		size_t count = min(pending.size() - first, (size_t)TCP_MAX_IOV);
+		this->iov.resize(count);
+		for (size_t n = 0; n < count; n++) {
+			this->iov[n].iov_base = (void*)pending[first + n].c_str();
+			this->iov[n].iov_len = pending[first + n].length() + 1;
+		}
+		this->iov[0].iov_base = (char*)this->iov[0].iov_base + offset;
+		this->iov[0].iov_len -= offset;
 
-		if (bytes > 0) {
-			size_t i = 0;
-			while (i < (size_t)bytes) {
-				size_t len = strnlen(&buffer[i], TCP_BUFFER_SIZE - i);
-				msg += string(&buffer[i], len);
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(struct msghdr));
+		msg.msg_iov = &this->iov[0];
+		msg.msg_iovlen = count;
 
-				if (i + len >= (size_t)bytes) {
-					//message nicht komplett, warte auf weitere pakete
-				}
-				else {
-					//message komplett
-					result = (int)bytes;
-					break;
+		ssize_t lenSent = sendmsg(this->sock, &msg, MSG_NOSIGNAL);
+		if (lenSent == -1) {
+			if (errno == EINTR) {
+				continue;
+			}
+			if (errno == EAGAIN || errno == EWOULDBLOCK) {
+				// newer values can still replace pending ones until the socket is writable again
+				if (!this->waitsWritable) {
+					this->reactor->modify(this->reactorId, EPOLLIN | EPOLLOUT);
+					this->waitsWritable = true;
 				}
-
-				//suche nach weiteren messages im stream
-				i += strnlen(&buffer[i], TCP_BUFFER_SIZE - i) + 1;
+				return;
 			}
+			this->reportConnectionLost();
+			return;
 		}
-		else if (bytes == -1) {
-			result = -1;
+
+		size_t messages = this->sendQueue.consume((size_t)lenSent);
+
+		const std::lock_guard<std::mutex> lock(this->sendStatsMutex);
+		this->sendStats.messages += messages;
+		this->sendStats.bytes += (size_t)lenSent;
+		this->sendStats.syscalls++;
+		if (!this->sendQueue.isPending()) {
+			this->sendStats.flushes++;
 		}
 	}
-	
-	setBlock(this->sock, true);
 
-	return result;
+	if (this->waitsWritable) {
+		this->reactor->modify(this->reactorId, EPOLLIN);
+		this->waitsWritable = false;
+	}
 }
 
 bool TCPClient::send(const string &data) {
-	if(this->sock) {
-		size_t p=0;
-		while(p < data.length() + 1)
-		{
-			size_t len = TCP_BUFFER_SIZE;
-			if(len > data.length() + 1  - p)
-			{
-				len = data.length() + 1 - p;
-			}
-			ssize_t lenSent = write(this->sock, data.substr(p).c_str(), len);
-			if(lenSent == -1) {
+	if (!this->sock || !this->reactorId || this->connectionLost) {
+		return false;
+	}
 
-				if (this->MessageCallback) {
-					this->MessageCallback(MSG_CLIENT_CONNECTION_LOST, "");
-				}
-				return false;
-			}
-			
-			p += lenSent;
-		}
+	if (!this->sendQueue.push(data)) {
+		return false;
+	}
+	if (!this->sendSignaled.exchange(true)) {
+		this->reactor->notify(this->reactorId);
 	}
 	return true;
+}
+
+TCPSendStats TCPClient::getSendStats() {
+	const std::lock_guard<std::mutex> lock(this->sendStatsMutex);
+	TCPSendStats stats = this->sendStats;
+	stats.coalesced = this->sendQueue.getCoalesced();
+	stats.dropped = this->sendQueue.getDropped();
+	return stats;
 }
\ No newline at end of file
@@ -32,47 +32,114 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #include <sys/socket.h>
 #include <ifaddrs.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <netdb.h>
+#include <limits.h>
+#include <sys/uio.h>
 #include <string>
 #include <unistd.h>
 #include <stdexcept>
 #include <vector>
+#include <chrono>
+#include <string_view>
+#include <mutex>
+#include <atomic>
 #include "translator.h"
+#include "framebuffer.h"
+#include "netmessage.h"
+#include "sendqueue.h"
+#include "reactor_linux.h"
 
 using namespace std;
 
 #define TCP_BUFFER_SIZE 512
 #define TCP_TIMEOUT 2000
+#define TCP_MAX_IOV IOV_MAX
+#define TCP_SCAN_BURST 50 // ms, probes of that much time the rate limit of a scan lets go at once
 
-#define MSG_CLIENT_CONNECTED		1
-#define MSG_CLIENT_DISCONNECTED		2
-#define MSG_CLIENT_CONNECTION_LOST	3
-#define MSG_TEXT					4
+struct IPv4Interface {
+	string ip;
+	uint32_t address; // host byte order
+	uint32_t netmask; // host byte order
+};
+
+struct TCPRaceResult {
+	string host;
+	long long connectTime; // microseconds, -1 if not connected
+	long long answerTime; // microseconds until the first message arrived, -1 if none
+};
+
+struct TCPSocketProfile {
+	bool nodelay; // disables Nagle, the small set messages go out at once
+	bool keepalive;
+	int keepalive_idle; // seconds, 0 = system default
+	int keepalive_interval; // seconds, 0 = system default
+	int keepalive_count; // 0 = system default
+	int rcvbuf; // bytes, 0 = system default
+	int sndbuf; // bytes, 0 = system default
+	int dscp; // 0 = not marked, 46 = expedited forwarding
+};
 
 class TCPClient
 {
 private:
 	int sock;
-	SDL_Thread *receiveThreadHandle;
-	bool receiveThreadIsRunning;
+	NetworkReactor *reactor;
+	uint64_t reactorId;
+	FrameBuffer frameBuffer; // reactor thread only
+	vector<struct iovec> iov; // reactor thread only
+	bool waitsWritable; // reactor thread only
+	atomic<bool> sendSignaled;
+	SendQueue sendQueue;
+	mutex sendStatsMutex;
+	TCPSendStats sendStats;
+	atomic<bool> connectionLost;
+	mutex callbackMutex; // a lost connection is reported once, to the callback in effect
+	bool lostReported; // callbackMutex
 public:
 	TCPClient();
-	TCPClient(const string &host, const string &port, void (*MessageCallback)(int,const string&), int timeout = TCP_TIMEOUT); // throws exception
+	TCPClient(const string &host, const string &port, void (*MessageCallback)(int, string_view), int timeout = TCP_TIMEOUT); // throws exception
+	TCPClient(int sock, void (*MessageCallback)(int, string_view)); // adopts a connected socket, throws exception
 	~TCPClient();
-	bool send(const string &data);
-	int receive(string &msg, int timeout = TCP_TIMEOUT);
+	bool send(const string &data); // queues data for the reactor thread; never blocks
+	TCPSendStats getSendStats();
+	string getSocketInfo();
+	// messages go to MessageCallback from now on, a connection lost before is reported to it
+	void setMessageCallback(void (*MessageCallback)(int, string_view));
 
-	static bool getClientIPs(vector<string>& ips);
+	static bool initNetwork();
+	static void cancelNetwork(); // pending scans and connects fail, call before releaseNetwork()
+	static void releaseNetwork();
+	// connects to all hosts at once and keeps the first connection that answers the handshake, throws exception
+	static TCPClient* race(const vector<string>& hosts, const string& port, void (*MessageCallback)(int, string_view), const string& handshake,
+		vector<TCPRaceResult>& results, int& winner, int timeout = TCP_TIMEOUT);
+	static bool getClientInterfaces(vector<IPv4Interface>& interfaces);
+	static string addressToString(uint32_t address);
+	static bool stringToAddress(const string& ip, uint32_t& address);
+	static string resolveHost(const string& host); // throws exception
+	static int connectNonBlock(const string& host, const string& port, const TCPSocketProfile* profile = NULL); // throws exception
+	static void setSocketProfile(const TCPSocketProfile& profile); // used by all following connections
+	static string getSocketInfo(int sock); // the options in effect
 	static string getComputerNameByIP(const string& ip);
-	static bool lookUpServers(const string& ipMask, int start, int end, const string& port, int timeout, vector<string>& servers);
+	// probes the addresses, at most maxProbes at a time and probesPerSecond (0 = unlimited);
+	// ServerFound is called as soon as a server answers (rtt in microseconds), ScanProgress with the number of finished probes
+	static bool lookUpServers(const vector<uint32_t>& addresses, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+		void (*ServerFound)(const string& ip, unsigned int rtt) = NULL, void (*ScanProgress)(unsigned int probed) = NULL);
+	static bool lookUpServers(uint32_t first, uint32_t count, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+		void (*ServerFound)(const string& ip, unsigned int rtt) = NULL, void (*ScanProgress)(unsigned int probed) = NULL);
 private:
-	static int SDLCALL receiveThread(void* param);
-	void (*MessageCallback)(int msg, const string &data);
+	void start(); // throws exception
+	void onEvents(uint32_t events);
+	void onReadable();
+	void flush();
+	void reportConnectionLost();
+	atomic<void (*)(int msg, string_view data)> MessageCallback;
 	static bool setBlock(int sock, bool block);
-	static int connectNonBlock(const string& host, const string& port);
+	static void applySocketProfile(int sock, const TCPSocketProfile& profile);
+	static TCPSocketProfile socketProfile;
 };
 
 #endif
\ No newline at end of file
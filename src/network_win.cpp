@@ -31,6 +31,10 @@ bool TCPClient::initNetwork() {
 	return true;
 }
 
+void TCPClient::cancelNetwork() {
+	// nothing to cancel, scans and connects are blocking calls with their own timeouts
+}
+
 void TCPClient::releaseNetwork() {
 	WSACleanup();
 }
@@ -56,110 +60,234 @@ string TCPClient::getComputerNameByIP(const string &ip) {
 	return string(hostname);
 }
 
-bool TCPClient::getClientIPs(vector<string>& ips) {
+bool TCPClient::getClientInterfaces(vector<IPv4Interface>& interfaces) {
 
-	WSADATA wsadata;
-	if (WSAStartup(MAKEWORD(2, 2), &wsadata) == SOCKET_ERROR) {
+	ULONG size = sizeof(IP_ADAPTER_INFO);
+	vector<char> buffer(size);
+	ULONG res = GetAdaptersInfo((PIP_ADAPTER_INFO)&buffer[0], &size);
+	if (res == ERROR_BUFFER_OVERFLOW) {
+		buffer.resize(size);
+		res = GetAdaptersInfo((PIP_ADAPTER_INFO)&buffer[0], &size);
+	}
+	if (res != NO_ERROR) {
 		return false;
 	}
 
-	char hostname[NI_MAXHOST];
-	if (gethostname(hostname, NI_MAXHOST) == SOCKET_ERROR) {
-		return false;
+	for (PIP_ADAPTER_INFO adapter = (PIP_ADAPTER_INFO)&buffer[0]; adapter; adapter = adapter->Next) {
+		for (PIP_ADDR_STRING addr = &adapter->IpAddressList; addr; addr = addr->Next) {
+			struct in_addr address, netmask;
+			if (inet_pton(AF_INET, addr->IpAddress.String, &address) != 1 || address.s_addr == 0) {
+				continue;
+			}
+			IPv4Interface iface;
+			iface.ip = string(addr->IpAddress.String);
+			iface.address = ntohl(address.s_addr);
+			if (inet_pton(AF_INET, addr->IpMask.String, &netmask) == 1) {
+				iface.netmask = ntohl(netmask.s_addr);
+			}
+			else {
+				iface.netmask = 0xFFFFFF00;
+			}
+			interfaces.push_back(iface);
+		}
 	}
 
-	hostent* h = gethostbyname(hostname);
-	if (!h) {
+	return true;
+}
+
+string TCPClient::addressToString(uint32_t address) {
+	struct in_addr addr;
+	addr.s_addr = htonl(address);
+	char addressBuffer[INET_ADDRSTRLEN];
+	if (inet_ntop(AF_INET, &addr, addressBuffer, INET_ADDRSTRLEN)) {
+		return string(addressBuffer);
+	}
+	return "";
+}
+
+bool TCPClient::stringToAddress(const string& ip, uint32_t& address) {
+	struct in_addr addr;
+	if (inet_pton(AF_INET, ip.c_str(), &addr) != 1) {
 		return false;
 	}
+	address = ntohl(addr.s_addr);
+	return true;
+}
 
-	bool result = true;
-	for (int i = 0; h->h_addr_list[i]; i++) {
-		char* ip = inet_ntoa(*(in_addr*)(h->h_addr_list[i]));
-		if (!ip) {
-			result = false;
-		}
-		else {
-			ips.push_back(string(ip));
-		}
+string TCPClient::resolveHost(const string& host) {
+	struct addrinfo hints, * result;
+	memset(&hints, 0, sizeof(struct addrinfo));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_protocol = IPPROTO_TCP;
+
+	if (getaddrinfo(host.c_str(), NULL, &hints, &result) != 0) {
+		throw invalid_argument("Error on resolving hostname on " + host);
+	}
+	if (!result) {
+		throw invalid_argument("Error on resolving hostname (result == NULL) on " + host);
 	}
 
-	return result;
+	string ip = addressToString(ntohl(((struct sockaddr_in*)result->ai_addr)->sin_addr.s_addr));
+	freeaddrinfo(result);
+
+	if (ip.empty()) {
+		throw invalid_argument("Error on resolving hostname on " + host);
+	}
+	return ip;
 }
 
-bool TCPClient::lookUpServers(const string& ipMask, int start, int end, const string& port, int timeout, vector<string> &servers) {
+bool TCPClient::lookUpServers(uint32_t first, uint32_t count, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+	void (__cdecl *ServerFound)(const string& ip, unsigned int rtt), void (__cdecl *ScanProgress)(unsigned int probed)) {
+
+	vector<uint32_t> addresses(count);
+	for (uint32_t n = 0; n < count; n++) {
+		addresses[n] = first + n;
+	}
+	return lookUpServers(addresses, port, timeout, maxProbes, probesPerSecond, servers, ServerFound, ScanProgress);
+}
 
-	int range = end - start;
+bool TCPClient::lookUpServers(const vector<uint32_t>& addresses, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+	void (__cdecl *ServerFound)(const string& ip, unsigned int rtt), void (__cdecl *ScanProgress)(unsigned int probed)) {
 
-	if (range < 1) {
+	if (addresses.empty()) {
 		return false;
 	}
 
-	struct pollfd *fds = new struct pollfd[range];
-	if (!fds) {
-		return false;
+	maxProbes = max(maxProbes, 1);
+	probesPerSecond = max(probesPerSecond, 0);
+
+	vector<struct pollfd> fds(maxProbes);
+	vector<chrono::steady_clock::time_point> started(maxProbes);
+	vector<uint32_t> probed(maxProbes);
+	vector<struct pollfd> polled;
+	vector<int> slots;
+	for (int i = 0; i < maxProbes; i++) {
+		fds[i].fd = INVALID_SOCKET;
+		fds[i].events = POLLOUT;
+		fds[i].revents = 0;
 	}
 
-	memset(fds, 0, sizeof(struct pollfd) * range);
+	// token bucket, allows bursts of TCP_SCAN_BURST
+	double burst = max(1.0, (double)probesPerSecond * TCP_SCAN_BURST / 1000.0);
+	double tokens = burst;
+	unsigned long long refilled = GetTickCount64();
+
+	size_t next = 0;
+	int active = 0;
+	while (next < addresses.size() || active > 0) {
+		unsigned long long now = GetTickCount64();
+		if (probesPerSecond > 0) {
+			tokens = min(burst, tokens + (double)(now - refilled) * probesPerSecond / 1000.0);
+			refilled = now;
+		}
 
-	for (int n = 0; n < range; n++) {
-		string ip = ipMask + to_string(n + start);
-		try {
-			SOCKET sock = connectNonBlock(ip, port);
-			if (sock) {
-				fds[n].fd = sock;
-				fds[n].events = POLLOUT;
+		for (int i = 0; i < maxProbes && next < addresses.size(); i++) {
+			if (fds[i].fd != INVALID_SOCKET) {
+				continue;
 			}
-			else {
-				fds[n].fd = -1;
+			if (probesPerSecond > 0 && tokens < 1.0) {
+				break;
+			}
+			tokens -= 1.0;
+
+			probed[i] = addresses[next];
+			next++;
+			try {
+				fds[i].fd = connectNonBlock(addressToString(probed[i]), port);
+				started[i] = chrono::steady_clock::now();
+				active++;
+			}
+			catch (invalid_argument&) {
+				fds[i].fd = INVALID_SOCKET;
+				if (ScanProgress) {
+					ScanProgress(1);
+				}
 			}
 		}
-		catch (invalid_argument&) {
+
+		// sleep until the next probe times out, or a token is due for a free slot
+		int wait = INT_MAX;
+		if (probesPerSecond > 0 && tokens < 1.0 && next < addresses.size() && active < maxProbes) {
+			wait = (int)((1.0 - tokens) * 1000.0 / probesPerSecond) + 1;
+		}
+		if (active == 0) {
+			if (next < addresses.size() && wait != INT_MAX) {
+				Sleep((DWORD)wait);
+			}
+			continue;
 		}
-	}
 
-	unsigned long long time = GetTickCount64();
-	int n = 0;
-	while (n < 254 && time + timeout > GetTickCount64() ) {
-		int res = WSAPoll(fds, range, timeout / 10);
-		if (res < 1) {
+		// only pass open sockets, older WSAPoll versions fail on INVALID_SOCKET
+		polled.clear();
+		chrono::steady_clock::time_point pollStart = chrono::steady_clock::now();
+		for (int i = 0; i < maxProbes; i++) {
+			if (fds[i].fd != INVALID_SOCKET) {
+				fds[i].revents = 0;
+				polled.push_back(fds[i]);
+				slots.push_back(i);
+				long long left = (long long)timeout * 1000 - chrono::duration_cast<chrono::microseconds>(pollStart - started[i]).count();
+				wait = min(wait, (int)max((left + 999) / 1000, 0LL)); // rounded up, the probe has timed out then
+			}
+		}
+		int res = WSAPoll(&polled[0], (ULONG)polled.size(), wait);
+		if (res == SOCKET_ERROR) {
 			break;
 		}
-		else {
-			for (int i = 0; i < range; i++) {
-				if (fds[i].revents == POLLOUT) {
-					closesocket(fds[i].fd);
-					fds[i].fd = -1;
-					servers.push_back(ipMask + to_string(i + start));
-					n++;
-				}
-				else if (fds[i].revents == POLLERR || fds[i].revents == POLLHUP || fds[i].revents == POLLNVAL) {
-					closesocket(fds[i].fd);
-					fds[i].fd = -1;
-					n++;
+
+		chrono::steady_clock::time_point polledAt = chrono::steady_clock::now();
+		for (size_t p = 0; p < polled.size(); p++) {
+			int i = slots[p];
+			long long elapsed = chrono::duration_cast<chrono::microseconds>(polledAt - started[i]).count();
+			bool timedOut = elapsed >= (long long)timeout * 1000;
+			if (polled[p].revents == 0 && !timedOut) {
+				continue;
+			}
+			if (polled[p].revents == POLLOUT) {
+				servers.push_back(addressToString(probed[i]));
+				if (ServerFound) {
+					ServerFound(servers.back(), (unsigned int)elapsed);
 				}
 			}
+			closesocket(fds[i].fd);
+			fds[i].fd = INVALID_SOCKET;
+			active--;
+			if (ScanProgress) {
+				ScanProgress(1);
+			}
 		}
+		slots.clear();
 	}
-	if (fds) {
-		delete[] fds;
-		fds = NULL;
+
+	for (int i = 0; i < maxProbes; i++) {
+		if (fds[i].fd != INVALID_SOCKET) {
+			closesocket(fds[i].fd);
+		}
 	}
 	return true;
 }
 
+TCPSocketProfile TCPClient::socketProfile = { true, false, 0, 0, 0, 0, 0, 0 };
+
 TCPClient::TCPClient() {
 	this->MessageCallback = NULL;
 	this->receiveThreadHandle = NULL;
 	this->receiveThreadIsRunning = false;
+	this->sendThreadHandle = NULL;
+	this->sendThreadIsRunning = false;
+	this->sendSignal = NULL;
+	this->sendSignaled = false;
+	this->connectionLost = false;
+	this->lostReported = false;
 	this->sock = 0;
+	memset(&this->sendStats, 0, sizeof(TCPSendStats));
 }
 
-TCPClient::TCPClient(const string &host, const string &port, void (__cdecl *MessageCallback)(int,const string&), int timeout) : TCPClient() {
+TCPClient::TCPClient(const string &host, const string &port, void (__cdecl *MessageCallback)(int, string_view), int timeout) : TCPClient() {
 
 	this->MessageCallback = MessageCallback;
 
-	this->sock = this->connectNonBlock(host, port); // throws exception
+	this->sock = this->connectNonBlock(host, port, &socketProfile); // throws exception
 
 	struct pollfd fds[1];
 	memset(fds, 0, sizeof(struct pollfd));
@@ -172,6 +300,18 @@ TCPClient::TCPClient(const string &host, const string &port, void (__cdecl *Mess
 		throw invalid_argument("Error on poll (" + to_string(res) + ") " + host + ":" + port);
 	}
 
+	this->start(); // throws exception
+}
+
+TCPClient::TCPClient(SOCKET sock, void (__cdecl *MessageCallback)(int, string_view)) : TCPClient() {
+
+	this->MessageCallback = MessageCallback;
+	this->sock = sock;
+
+	this->start(); // throws exception
+}
+
+void TCPClient::start() {
 	if (!setBlock(this->sock, true)) {
 		shutdown(this->sock, SD_BOTH);
 		closesocket(this->sock);
@@ -179,13 +319,33 @@ TCPClient::TCPClient(const string &host, const string &port, void (__cdecl *Mess
 		throw invalid_argument("Error on setBlock");
 	}
 
-	if (this->MessageCallback) {
+	this->sendSignal = CreateEvent(NULL, FALSE, FALSE, NULL);
+	this->sendThreadIsRunning = true;
+	if (this->sendSignal) {
+		this->sendThreadHandle = CreateThread(NULL, 0, this->sendThread, (void*)this, NULL, NULL);
+	}
+	if (!this->sendThreadHandle) {
+		this->sendThreadIsRunning = false;
+		if (this->sendSignal) {
+			CloseHandle(this->sendSignal);
+			this->sendSignal = NULL;
+		}
+		shutdown(this->sock, SD_BOTH);
+		closesocket(this->sock);
+		this->sock = 0;
+		throw invalid_argument("Error on creating send thread");
+	}
+
+	void (__cdecl *callback)(int, string_view) = this->MessageCallback;
+	if (callback) {
 		this->receiveThreadHandle = CreateThread(NULL, 0, this->receiveThread, (void*)this, NULL, NULL);
 		if (this->receiveThreadHandle) {
-			this->MessageCallback(MSG_CLIENT_CONNECTED, "");
+			callback(MSG_CLIENT_CONNECTED, "");
 		}
 		else {
-			shutdown(this->sock, SD_BOTH);
+			this->connectionLost = true;
+			shutdown(this->sock, SD_BOTH); // returns a WSASend blocked on a stalled link
+			this->stopSendThread();
 			closesocket(this->sock);
 			this->sock = 0;
 			throw invalid_argument("Error on creating thread");
@@ -193,13 +353,128 @@ TCPClient::TCPClient(const string &host, const string &port, void (__cdecl *Mess
 	}
 }
 
+TCPClient* TCPClient::race(const vector<string>& hosts, const string& port, void (__cdecl *MessageCallback)(int, string_view), const string& handshake,
+	vector<TCPRaceResult>& results, int& winner, int timeout) {
+
+	chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+	vector<struct pollfd> fds(hosts.size());
+	results.resize(hosts.size());
+	for (size_t n = 0; n < hosts.size(); n++) {
+		results[n].host = hosts[n];
+		results[n].connectTime = -1;
+		results[n].answerTime = -1;
+		fds[n].events = POLLOUT;
+		fds[n].revents = 0;
+		try {
+			fds[n].fd = connectNonBlock(hosts[n], port, &socketProfile);
+		}
+		catch (invalid_argument&) {
+			fds[n].fd = INVALID_SOCKET;
+		}
+	}
+
+	winner = -1;
+	vector<struct pollfd> polled;
+	vector<size_t> slots;
+	while (winner == -1) {
+		long long elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count();
+		if (elapsed >= (long long)timeout * 1000) {
+			break;
+		}
+
+		// only pass open sockets, older WSAPoll versions fail on INVALID_SOCKET
+		polled.clear();
+		slots.clear();
+		for (size_t n = 0; n < fds.size(); n++) {
+			if (fds[n].fd != INVALID_SOCKET) {
+				fds[n].revents = 0;
+				polled.push_back(fds[n]);
+				slots.push_back(n);
+			}
+		}
+		if (polled.empty()) {
+			break;
+		}
+
+		int res = WSAPoll(&polled[0], (ULONG)polled.size(), timeout - (int)(elapsed / 1000));
+		if (res == SOCKET_ERROR) {
+			break;
+		}
+
+		elapsed = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - started).count();
+		for (size_t p = 0; p < polled.size() && winner == -1; p++) {
+			size_t n = slots[p];
+			if (polled[p].revents == 0) {
+				continue;
+			}
+
+			bool drop = false;
+			if (fds[n].events == POLLOUT) {
+				if (polled[p].revents != POLLOUT) {
+					drop = true;
+				}
+				else {
+					results[n].connectTime = elapsed;
+					// the handshake is tiny, it fits into the empty socket buffer
+					int sent = ::send(fds[n].fd, handshake.c_str(), (int)handshake.length() + 1, 0);
+					if (sent != (int)handshake.length() + 1) {
+						drop = true;
+					}
+					fds[n].events = POLLIN;
+				}
+			}
+			else {
+				// the first complete message is the answer, it is dropped since the winner asks again
+				char buffer[TCP_BUFFER_SIZE];
+				int bytes = recv(fds[n].fd, buffer, TCP_BUFFER_SIZE, 0);
+				if (bytes > 0) {
+					if (memchr(buffer, 0, (size_t)bytes)) {
+						results[n].answerTime = elapsed;
+						winner = (int)n;
+					}
+				}
+				else if (bytes == 0 || WSAGetLastError() != WSAEWOULDBLOCK) {
+					drop = true;
+				}
+			}
+
+			if (drop) {
+				closesocket(fds[n].fd);
+				fds[n].fd = INVALID_SOCKET;
+			}
+		}
+	}
+
+	// the winner's socket is handed over, all others are closed
+	for (size_t n = 0; n < fds.size(); n++) {
+		if ((int)n != winner && fds[n].fd != INVALID_SOCKET) {
+			closesocket(fds[n].fd);
+		}
+	}
+
+	if (winner == -1) {
+		throw invalid_argument("No server answered");
+	}
+
+	return new TCPClient(fds[winner].fd, MessageCallback); // throws exception
+}
+
 TCPClient::~TCPClient() {
+
 	if(this->sock) {
-		if (this->MessageCallback) {
-			this->MessageCallback(MSG_CLIENT_DISCONNECTED, "");
+		void (__cdecl *callback)(int, string_view) = this->MessageCallback.exchange(NULL);
+		if (callback) {
+			callback(MSG_CLIENT_DISCONNECTED, "");
 		}
-		this->MessageCallback = NULL;
+		this->connectionLost = true; // the failing send and receive are no lost connection
+		// before joining the send thread, a WSASend blocked on a stalled link returns then
 		shutdown(this->sock, SD_BOTH);
+	}
+
+	this->stopSendThread();
+
+	if (this->sock) {
 		closesocket(this->sock);
 		this->sock = NULL;
 	}
@@ -223,7 +498,73 @@ bool TCPClient::setBlock(SOCKET sock, bool block) {
 	return true;
 }
 
-SOCKET TCPClient::connectNonBlock(const string &host, const string &port) {
+void TCPClient::setSocketProfile(const TCPSocketProfile& profile) {
+	socketProfile = profile;
+}
+
+void TCPClient::applySocketProfile(SOCKET sock, const TCPSocketProfile& profile) {
+	// failing options are not fatal, getSocketInfo shows what is in effect
+	BOOL val = profile.nodelay ? TRUE : FALSE;
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char*)&val, sizeof(val));
+
+	if (profile.keepalive && (profile.keepalive_idle > 0 || profile.keepalive_interval > 0)) {
+		// the probe count is fixed by the system
+		struct tcp_keepalive alive;
+		alive.onoff = 1;
+		alive.keepalivetime = (profile.keepalive_idle > 0 ? profile.keepalive_idle : 7200) * 1000;
+		alive.keepaliveinterval = (profile.keepalive_interval > 0 ? profile.keepalive_interval : 1) * 1000;
+		DWORD bytes = 0;
+		WSAIoctl(sock, SIO_KEEPALIVE_VALS, &alive, sizeof(alive), NULL, 0, &bytes, NULL, NULL);
+	}
+	else {
+		val = profile.keepalive ? TRUE : FALSE;
+		setsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (const char*)&val, sizeof(val));
+	}
+
+	// buffers have to be set before connect to take effect on the window scaling
+	if (profile.rcvbuf > 0) {
+		setsockopt(sock, SOL_SOCKET, SO_RCVBUF, (const char*)&profile.rcvbuf, sizeof(int));
+	}
+	if (profile.sndbuf > 0) {
+		setsockopt(sock, SOL_SOCKET, SO_SNDBUF, (const char*)&profile.sndbuf, sizeof(int));
+	}
+
+	// windows ignores IP_TOS unless DSCP marking is allowed by policy
+	if (profile.dscp > 0) {
+		DWORD tos = (profile.dscp & 0x3F) << 2;
+		setsockopt(sock, IPPROTO_IP, IP_TOS, (const char*)&tos, sizeof(tos));
+	}
+}
+
+string TCPClient::getSocketInfo(SOCKET sock) {
+	BOOL nodelay = FALSE, keepalive = FALSE;
+	int rcvbuf = 0, sndbuf = 0;
+	DWORD tos = 0;
+	int len = sizeof(BOOL);
+	getsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char*)&nodelay, &len);
+	len = sizeof(BOOL);
+	getsockopt(sock, SOL_SOCKET, SO_KEEPALIVE, (char*)&keepalive, &len);
+	len = sizeof(int);
+	getsockopt(sock, SOL_SOCKET, SO_RCVBUF, (char*)&rcvbuf, &len);
+	len = sizeof(int);
+	getsockopt(sock, SOL_SOCKET, SO_SNDBUF, (char*)&sndbuf, &len);
+	len = sizeof(DWORD);
+	getsockopt(sock, IPPROTO_IP, IP_TOS, (char*)&tos, &len);
+
+	string info = "nodelay " + to_string(nodelay ? 1 : 0) + ", keepalive " + to_string(keepalive ? 1 : 0);
+	if (keepalive && (socketProfile.keepalive_idle > 0 || socketProfile.keepalive_interval > 0)) {
+		// SIO_KEEPALIVE_VALS can't be read back
+		info += " (idle " + to_string(socketProfile.keepalive_idle) + " s, interval " + to_string(socketProfile.keepalive_interval) + " s)";
+	}
+	info += ", rcvbuf " + to_string(rcvbuf) + ", sndbuf " + to_string(sndbuf) + ", dscp " + to_string(tos >> 2);
+	return info;
+}
+
+string TCPClient::getSocketInfo() {
+	return getSocketInfo(this->sock);
+}
+
+SOCKET TCPClient::connectNonBlock(const string &host, const string &port, const TCPSocketProfile* profile) {
 	SOCKET sock = 0;
 	struct addrinfo hints, * result;
 	memset(&hints, 0, sizeof(struct addrinfo));
@@ -247,12 +588,18 @@ SOCKET TCPClient::connectNonBlock(const string &host, const string &port) {
 
 	if (!setBlock(sock, false)) {
 		freeaddrinfo(result);
+		closesocket(sock);
 		throw invalid_argument("Error on setBlock");
 	}
 
+	if (profile) {
+		applySocketProfile(sock, *profile);
+	}
+
 	if (connect(sock, result->ai_addr, (int)result->ai_addrlen) == -1) {
 		if (WSAGetLastError() != WSAEWOULDBLOCK) {
 			freeaddrinfo(result);
+			closesocket(sock);
 			throw invalid_argument("Error on connecting to " + host + ":" + port);
 		}
 	}
@@ -279,37 +626,24 @@ DWORD WINAPI TCPClient::receiveThread(void *param)
 	TCPClient *tcpClient=(TCPClient*)param;
 	tcpClient->receiveThreadIsRunning = true;
 
-	char buffer[TCP_BUFFER_SIZE];
-	string completeMessage;
+	FrameBuffer frameBuffer;
 
 	while(tcpClient->sock) {
-		int bytes = recv(tcpClient->sock, buffer, TCP_BUFFER_SIZE, 0);
+		size_t space = 0;
+		char *buffer = frameBuffer.prepareWrite(space);
+		int bytes = recv(tcpClient->sock, buffer, (int)space, 0);
 
 		if(bytes > 0) {
-			size_t i = 0;
-			while (i < (size_t)bytes) {
-				size_t len = strnlen(&buffer[i], TCP_BUFFER_SIZE - i);
-				completeMessage += string(&buffer[i], len);
+			frameBuffer.commitWrite((size_t)bytes);
 
-				if (i + len >= (size_t)bytes) {
-					//message nicht komplett, warte auf weitere pakete
-				}
-				else {
-					//message komplett
-					if (tcpClient->MessageCallback) {
-						tcpClient->MessageCallback(MSG_TEXT, completeMessage);
-					}
-					completeMessage = "";
-				}
-
-				//suche nach weiteren messages im stream
-				i += strnlen(&buffer[i], TCP_BUFFER_SIZE - i) + 1;
-			}			
+			string_view batch;
+			void (__cdecl *callback)(int, string_view) = tcpClient->MessageCallback.load(memory_order_acquire);
+			if (frameBuffer.nextBatch(batch) && callback) {
+				callback(MSG_TEXT_BATCH, batch);
+			}
 		}
 		else {
-			if (tcpClient->MessageCallback) {
-				tcpClient->MessageCallback(MSG_CLIENT_CONNECTION_LOST, "");
-			}
+			tcpClient->reportConnectionLost();
 			break;
 		}
 	}
@@ -369,26 +703,115 @@ int TCPClient::receive(string& msg, int timeout) {
 	return result;
 }
 
-bool TCPClient::send(const string &data) {
-	if(this->sock) {
-		size_t p = 0;
-		while(p < data.length() + 1) {
-			int len = TCP_BUFFER_SIZE;
-			if(len > (int)(data.length() + 1 - p)) {
-				len = (int)(data.length() + 1 - p);
-			}
-			int lenSent = ::send(this->sock, data.substr(p).c_str() ,len,0);
-			if(lenSent == SOCKET_ERROR) {
-				int err = WSAGetLastError();
-				if (err != WSAEINTR) {
-					if (this->MessageCallback) {
-						this->MessageCallback(MSG_CLIENT_CONNECTION_LOST, "");
-					}
-					return false;
-				}
+void TCPClient::stopSendThread() {
+	if (this->sendThreadHandle) {
+		this->sendThreadIsRunning = false;
+		SetEvent(this->sendSignal);
+		WaitForSingleObject(this->sendThreadHandle, INFINITE);
+		CloseHandle(this->sendThreadHandle);
+		this->sendThreadHandle = NULL;
+	}
+	if (this->sendSignal) {
+		CloseHandle(this->sendSignal);
+		this->sendSignal = NULL;
+	}
+}
+
+void TCPClient::reportConnectionLost() {
+	// receive and send thread may both notice it
+	if (this->connectionLost.exchange(true)) {
+		return;
+	}
+
+	const std::lock_guard<std::mutex> lock(this->callbackMutex);
+	void (__cdecl *callback)(int, string_view) = this->MessageCallback;
+	if (callback) {
+		callback(MSG_CLIENT_CONNECTION_LOST, "");
+	}
+	this->lostReported = true;
+}
+
+void TCPClient::setMessageCallback(void (__cdecl *MessageCallback)(int, string_view)) {
+	const std::lock_guard<std::mutex> lock(this->callbackMutex);
+	this->MessageCallback = MessageCallback;
+	if (this->lostReported && MessageCallback) {
+		MessageCallback(MSG_CLIENT_CONNECTION_LOST, "");
+	}
+}
+
+DWORD WINAPI TCPClient::sendThread(void *param)
+{
+	TCPClient *tcpClient = (TCPClient*)param;
+
+	vector<WSABUF> bufs;
+
+	while (tcpClient->sendThreadIsRunning) {
+		if (!tcpClient->sendQueue.isPending()) {
+			WaitForSingleObject(tcpClient->sendSignal, 1000);
+		}
+		tcpClient->sendSignaled = false;
+		tcpClient->sendQueue.collect();
+
+		if (!tcpClient->sendQueue.isPending() || !tcpClient->sock) {
+			continue;
+		}
+
+		// one buffer per message including its terminating NUL
+		size_t first, offset;
+		const vector<string> &pending = tcpClient->sendQueue.getPending(first, offset);
+		size_t count = min(pending.size() - first, (size_t)TCP_MAX_IOV);
+		bufs.resize(count);
+		for (size_t n = 0; n < count; n++) {
+			bufs[n].buf = (CHAR*)pending[first + n].c_str();
+			bufs[n].len = (ULONG)(pending[first + n].length() + 1);
+		}
+		bufs[0].buf += offset;
+		bufs[0].len -= (ULONG)offset;
+
+		// the socket is shared with the blocking receive thread, so this call may block;
+		// newer values queued meanwhile replace the pending ones on the next round
+		DWORD lenSent = 0;
+		if (WSASend(tcpClient->sock, &bufs[0], (DWORD)count, &lenSent, 0, NULL, NULL) == SOCKET_ERROR) {
+			int err = WSAGetLastError();
+			if (err == WSAEINTR) {
+				continue;
 			}
-			p += (size_t)lenSent;
+			tcpClient->reportConnectionLost();
+			break;
+		}
+
+		size_t messages = tcpClient->sendQueue.consume((size_t)lenSent);
+
+		const std::lock_guard<std::mutex> lock(tcpClient->sendStatsMutex);
+		tcpClient->sendStats.messages += messages;
+		tcpClient->sendStats.bytes += (size_t)lenSent;
+		tcpClient->sendStats.syscalls++;
+		if (!tcpClient->sendQueue.isPending()) {
+			tcpClient->sendStats.flushes++;
 		}
 	}
+
+	return 0;
+}
+
+bool TCPClient::send(const string &data) {
+	if (!this->sock || !this->sendThreadIsRunning) {
+		return false;
+	}
+
+	if (!this->sendQueue.push(data)) {
+		return false;
+	}
+	if (!this->sendSignaled.exchange(true)) {
+		SetEvent(this->sendSignal);
+	}
 	return true;
 }
+
+TCPSendStats TCPClient::getSendStats() {
+	const std::lock_guard<std::mutex> lock(this->sendStatsMutex);
+	TCPSendStats stats = this->sendStats;
+	stats.coalesced = this->sendQueue.getCoalesced();
+	stats.dropped = this->sendQueue.getDropped();
+	return stats;
+}
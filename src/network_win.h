@@ -23,24 +23,56 @@ along with this program.  If not, see <https://www.gnu.org/licenses/>.
 #define _NETWORK_
 
 #include <ws2tcpip.h>
+#include <iphlpapi.h>
+#include <mstcpip.h>
 #include <windows.h>
+#include <stdint.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <exception>
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <chrono>
+#include <string_view>
+#include <mutex>
+#include <atomic>
+#include "framebuffer.h"
+#include "netmessage.h"
+#include "sendqueue.h"
 
 #pragma comment(lib,"Ws2_32.lib")
+#pragma comment(lib,"Iphlpapi.lib")
 
 using namespace std;
 
 #define TCP_BUFFER_SIZE 512
 #define TCP_TIMEOUT	2000
+#define TCP_MAX_IOV	1024
+#define TCP_SCAN_BURST	50 // ms, probes of that much time the rate limit of a scan lets go at once
 
-#define MSG_CLIENT_CONNECTED		1
-#define MSG_CLIENT_DISCONNECTED		2
-#define MSG_CLIENT_CONNECTION_LOST	3
-#define MSG_TEXT					4
+struct IPv4Interface {
+	string ip;
+	uint32_t address; // host byte order
+	uint32_t netmask; // host byte order
+};
+
+struct TCPRaceResult {
+	string host;
+	long long connectTime; // microseconds, -1 if not connected
+	long long answerTime; // microseconds until the first message arrived, -1 if none
+};
+
+struct TCPSocketProfile {
+	bool nodelay; // disables Nagle, the small set messages go out at once
+	bool keepalive;
+	int keepalive_idle; // seconds, 0 = system default
+	int keepalive_interval; // seconds, 0 = system default
+	int keepalive_count; // 0 = system default
+	int rcvbuf; // bytes, 0 = system default
+	int sndbuf; // bytes, 0 = system default
+	int dscp; // 0 = not marked, 46 = expedited forwarding
+};
 
 class TCPClient
 {
@@ -48,24 +80,59 @@ private:
 	SOCKET sock;
 	HANDLE receiveThreadHandle;
 	bool receiveThreadIsRunning;
+	HANDLE sendThreadHandle;
+	atomic<bool> sendThreadIsRunning;
+	HANDLE sendSignal;
+	atomic<bool> sendSignaled;
+	SendQueue sendQueue;
+	mutex sendStatsMutex;
+	TCPSendStats sendStats;
+	atomic<bool> connectionLost;
+	mutex callbackMutex; // a lost connection is reported once, to the callback in effect
+	bool lostReported; // callbackMutex
 public:
 	TCPClient();
-	TCPClient(const string &host, const string &port, void (__cdecl *MessageCallback)(int,const string&), int timeout = TCP_TIMEOUT);
+	TCPClient(const string &host, const string &port, void (__cdecl *MessageCallback)(int, string_view), int timeout = TCP_TIMEOUT);
+	TCPClient(SOCKET sock, void (__cdecl *MessageCallback)(int, string_view)); // adopts a connected socket, throws exception
 	~TCPClient();
-	bool send(const string &data);
+	bool send(const string &data); // queues data for the sender thread; never blocks
+	TCPSendStats getSendStats();
+	string getSocketInfo();
+	// messages go to MessageCallback from now on, a connection lost before is reported to it
+	void setMessageCallback(void (__cdecl *MessageCallback)(int, string_view));
 	int receive(string& msg, int timeout = TCP_TIMEOUT);
 
 	static bool initNetwork();
+	static void cancelNetwork(); // pending scans and connects fail, call before releaseNetwork()
 	static void releaseNetwork();
-	static bool getClientIPs(vector<string>& ips);
+	// connects to all hosts at once and keeps the first connection that answers the handshake, throws exception
+	static TCPClient* race(const vector<string>& hosts, const string& port, void (__cdecl *MessageCallback)(int, string_view), const string& handshake,
+		vector<TCPRaceResult>& results, int& winner, int timeout = TCP_TIMEOUT);
+	static bool getClientInterfaces(vector<IPv4Interface>& interfaces);
+	static string addressToString(uint32_t address);
+	static bool stringToAddress(const string& ip, uint32_t& address);
+	static string resolveHost(const string& host); // throws exception
+	static SOCKET connectNonBlock(const string& host, const string& port, const TCPSocketProfile* profile = NULL); // throws exception
+	static void setSocketProfile(const TCPSocketProfile& profile); // used by all following connections
+	static string getSocketInfo(SOCKET sock); // the options in effect
 	static string getComputerNameByIP(const string& ip);
-	static bool lookUpServers(const string& ipMask, int start, int end, const string& port, int timeout, vector<string>& servers);
+	// probes the addresses, at most maxProbes at a time and probesPerSecond (0 = unlimited);
+	// ServerFound is called as soon as a server answers (rtt in microseconds), ScanProgress with the number of finished probes
+	static bool lookUpServers(const vector<uint32_t>& addresses, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+		void (__cdecl *ServerFound)(const string& ip, unsigned int rtt) = NULL, void (__cdecl *ScanProgress)(unsigned int probed) = NULL);
+	static bool lookUpServers(uint32_t first, uint32_t count, const string& port, int timeout, int maxProbes, int probesPerSecond, vector<string>& servers,
+		void (__cdecl *ServerFound)(const string& ip, unsigned int rtt) = NULL, void (__cdecl *ScanProgress)(unsigned int probed) = NULL);
 
 private:
+	void start(); // throws exception
 	static DWORD WINAPI receiveThread(void *param);
-	void(*MessageCallback)(int msg, const string &data);
+	static DWORD WINAPI sendThread(void *param);
+	void stopSendThread();
+	void reportConnectionLost();
+	atomic<void (__cdecl *)(int msg, string_view data)> MessageCallback;
 	static bool setBlock(SOCKET sock, bool block);
-	static SOCKET connectNonBlock(const string& host, const string& port);
+	static void applySocketProfile(SOCKET sock, const TCPSocketProfile& profile);
+	static TCPSocketProfile socketProfile;
 };
 
 #endif _NETWORK_
\ No newline at end of file
@@ -0,0 +1,184 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _PATHROUTER_
+#define _PATHROUTER_
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <stddef.h>
+
+using namespace std;
+
+#define PATH_ROUTER_MAX_CAPTURES	4
+
+struct PathMatch {
+	int tag;		// given with the route
+	size_t count;	// number of captures
+	unsigned value[PATH_ROUTER_MAX_CAPTURES];
+	string_view segment[PATH_ROUTER_MAX_CAPTURES]; // points into the matched path
+};
+
+// Maps UA paths to handlers by a trie over the path segments, built once at startup.
+// A pattern segment "#" captures a decimal number (device, channel, send or meter index),
+// a last segment "*" matches any remaining segments. Literal segments are tried first,
+// then "#", then "*" of the current node; there is no backtracking.
+// A trailing '/' of the path is ignored. match() does not allocate.
+template <typename Handler>
+class PathRouter
+{
+private:
+	struct Node {
+		vector<pair<string, size_t>> children; // literal segment -> node
+		size_t number;	// node for "#", 0 = none
+		Handler handler;
+		int tag;
+		Handler rest;	// handler for "*"
+		int restTag;
+	};
+	vector<Node> nodes;
+
+	size_t addNode() {
+		Node node;
+		node.number = 0;
+		node.handler = NULL;
+		node.tag = 0;
+		node.rest = NULL;
+		node.restTag = 0;
+		this->nodes.push_back(node);
+		return this->nodes.size() - 1;
+	}
+
+	static bool nextSegment(string_view path, size_t &pos, string_view &segment) {
+		if (pos >= path.length()) {
+			return false;
+		}
+		size_t end = path.find('/', pos);
+		if (end == string_view::npos) {
+			end = path.length();
+		}
+		segment = path.substr(pos, end - pos);
+		pos = end + 1;
+		// ignore a trailing '/'
+		return !(segment.empty() && pos >= path.length());
+	}
+
+	static bool parseNumber(string_view segment, unsigned &value) {
+		if (segment.empty() || segment.length() > 9) {
+			return false;
+		}
+		value = 0;
+		for (size_t n = 0; n < segment.length(); n++) {
+			if (segment[n] < '0' || segment[n] > '9') {
+				return false;
+			}
+			value = value * 10 + (unsigned)(segment[n] - '0');
+		}
+		return true;
+	}
+
+public:
+	PathRouter() {
+		this->addNode(); // root
+	}
+
+	void add(const string &pattern, Handler handler, int tag = 0) {
+		size_t node = 0;
+		size_t pos = 1;
+		string_view segment;
+		while (nextSegment(pattern, pos, segment)) {
+			if (segment == "*") {
+				this->nodes[node].rest = handler;
+				this->nodes[node].restTag = tag;
+				return;
+			}
+			size_t child = 0;
+			if (segment == "#") {
+				child = this->nodes[node].number;
+				if (child == 0) {
+					child = this->addNode();
+					this->nodes[node].number = child;
+				}
+			}
+			else {
+				for (size_t n = 0; n < this->nodes[node].children.size(); n++) {
+					if (this->nodes[node].children[n].first == segment) {
+						child = this->nodes[node].children[n].second;
+						break;
+					}
+				}
+				if (child == 0) {
+					child = this->addNode();
+					this->nodes[node].children.push_back(make_pair(string(segment), child));
+				}
+			}
+			node = child;
+		}
+		this->nodes[node].handler = handler;
+		this->nodes[node].tag = tag;
+	}
+
+	Handler match(string_view path, PathMatch &match) const {
+		match.count = 0;
+		match.tag = 0;
+		if (path.empty() || path[0] != '/') {
+			return NULL;
+		}
+
+		size_t node = 0;
+		size_t pos = 1;
+		string_view segment;
+		while (nextSegment(path, pos, segment)) {
+			const Node &current = this->nodes[node];
+			size_t child = 0;
+			for (size_t n = 0; n < current.children.size(); n++) {
+				if (current.children[n].first == segment) {
+					child = current.children[n].second;
+					break;
+				}
+			}
+			unsigned value;
+			if (child == 0 && current.number != 0 && match.count < PATH_ROUTER_MAX_CAPTURES && parseNumber(segment, value)) {
+				match.value[match.count] = value;
+				match.segment[match.count] = segment;
+				match.count++;
+				child = current.number;
+			}
+			if (child == 0) {
+				match.tag = current.restTag;
+				return current.rest;
+			}
+			node = child;
+		}
+
+		const Node &last = this->nodes[node];
+		if (last.handler) {
+			match.tag = last.tag;
+			return last.handler;
+		}
+		match.tag = last.restTag;
+		return last.rest;
+	}
+};
+
+#endif
@@ -0,0 +1,363 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "reactor_linux.h"
+#include <sys/socket.h>
+#include <string.h>
+#include <future>
+#include <stdexcept>
+
+NetworkReactor *NetworkReactor::instance = NULL;
+
+NetworkReactor::NetworkReactor() {
+	this->nextId = 1; // 0 is the eventfd
+	this->running = false;
+
+	this->epollFd = epoll_create1(EPOLL_CLOEXEC);
+	if (this->epollFd == -1) {
+		throw invalid_argument("Error on epoll_create1");
+	}
+
+	this->eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (this->eventFd == -1) {
+		close(this->epollFd);
+		throw invalid_argument("Error on eventfd");
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(struct epoll_event));
+	ev.events = EPOLLIN;
+	ev.data.u64 = 0;
+	if (epoll_ctl(this->epollFd, EPOLL_CTL_ADD, this->eventFd, &ev) == -1) {
+		close(this->eventFd);
+		close(this->epollFd);
+		throw invalid_argument("Error on epoll_ctl");
+	}
+
+	this->running = true;
+	this->loopThreadHandle = thread(&NetworkReactor::loop, this);
+	this->loopThreadId = this->loopThreadHandle.get_id();
+}
+
+NetworkReactor::~NetworkReactor() {
+	this->shutdown();
+
+	for (unordered_map<uint64_t, Entry>::iterator it = this->entries.begin(); it != this->entries.end(); ++it) {
+		epoll_ctl(this->epollFd, EPOLL_CTL_DEL, it->second.fd, NULL);
+	}
+	this->entries.clear();
+	this->timers.clear();
+	this->timerDeadlines.clear();
+	this->stopHandlers.clear();
+
+	close(this->eventFd);
+	close(this->epollFd);
+}
+
+bool NetworkReactor::start() {
+	if (!instance) {
+		try {
+			instance = new NetworkReactor();
+		}
+		catch (const invalid_argument&) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void NetworkReactor::shutdown() {
+	{
+		const std::lock_guard<std::mutex> lock(this->tasksMutex);
+		this->running = false;
+	}
+	this->wakeUp();
+	if (this->loopThreadHandle.joinable()) {
+		this->loopThreadHandle.join();
+	}
+}
+
+void NetworkReactor::cancel() {
+	if (instance) {
+		instance->shutdown();
+	}
+}
+
+void NetworkReactor::stop() {
+	if (instance) {
+		delete instance;
+		instance = NULL;
+	}
+}
+
+NetworkReactor *NetworkReactor::get() {
+	return instance;
+}
+
+bool NetworkReactor::isLoopThread() {
+	return this_thread::get_id() == this->loopThreadId;
+}
+
+void NetworkReactor::wakeUp() {
+	uint64_t one = 1;
+	ssize_t res = write(this->eventFd, &one, sizeof(uint64_t));
+	(void)res;
+}
+
+bool NetworkReactor::post(ReactorTask task) {
+	{
+		const std::lock_guard<std::mutex> lock(this->tasksMutex);
+		if (!this->running) {
+			return false;
+		}
+		this->tasks.push_back(std::move(task));
+		if (this->tasks.size() > 1) {
+			return true; // loop has been woken up already
+		}
+	}
+	this->wakeUp();
+	return true;
+}
+
+bool NetworkReactor::call(ReactorTask task) {
+	if (this->isLoopThread()) {
+		task();
+		return true;
+	}
+
+	promise<void> done;
+	future<void> f = done.get_future();
+	if (!this->post([&task, &done] {
+		task();
+		done.set_value();
+	})) {
+		return false;
+	}
+	f.wait();
+	return true;
+}
+
+bool NetworkReactor::notify(uint64_t id) {
+	return this->post([this, id] {
+		unordered_map<uint64_t, Entry>::iterator it = this->entries.find(id);
+		if (it != this->entries.end()) {
+			shared_ptr<ReactorHandler> handler = it->second.handler;
+			(*handler)(REACTOR_NOTIFY);
+		}
+	});
+}
+
+uint64_t NetworkReactor::add(int fd, uint32_t events, ReactorHandler handler) {
+	uint64_t id = this->nextId++;
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(struct epoll_event));
+	ev.events = events;
+	ev.data.u64 = id;
+	if (epoll_ctl(this->epollFd, EPOLL_CTL_ADD, fd, &ev) == -1) {
+		return 0;
+	}
+
+	Entry entry;
+	entry.fd = fd;
+	entry.handler = make_shared<ReactorHandler>(std::move(handler));
+	this->entries.insert({ id, entry });
+	return id;
+}
+
+bool NetworkReactor::modify(uint64_t id, uint32_t events) {
+	unordered_map<uint64_t, Entry>::iterator it = this->entries.find(id);
+	if (it == this->entries.end()) {
+		return false;
+	}
+
+	struct epoll_event ev;
+	memset(&ev, 0, sizeof(struct epoll_event));
+	ev.events = events;
+	ev.data.u64 = id;
+	return epoll_ctl(this->epollFd, EPOLL_CTL_MOD, it->second.fd, &ev) == 0;
+}
+
+void NetworkReactor::remove(uint64_t id) {
+	unordered_map<uint64_t, Entry>::iterator it = this->entries.find(id);
+	if (it != this->entries.end()) {
+		epoll_ctl(this->epollFd, EPOLL_CTL_DEL, it->second.fd, NULL);
+		this->entries.erase(it);
+	}
+}
+
+uint64_t NetworkReactor::addTimer(unsigned int ms, ReactorTask task) {
+	uint64_t id = this->nextId++;
+	unsigned long long deadline = GetTickCount64() + ms;
+	this->timers.insert({ { deadline, id }, std::move(task) });
+	this->timerDeadlines.insert({ id, deadline });
+	return id;
+}
+
+void NetworkReactor::cancelTimer(uint64_t id) {
+	unordered_map<uint64_t, unsigned long long>::iterator it = this->timerDeadlines.find(id);
+	if (it != this->timerDeadlines.end()) {
+		this->timers.erase({ it->second, id });
+		this->timerDeadlines.erase(it);
+	}
+}
+
+uint64_t NetworkReactor::addStopHandler(ReactorTask task) {
+	uint64_t id = this->nextId++;
+	this->stopHandlers.insert({ id, std::move(task) });
+	return id;
+}
+
+void NetworkReactor::removeStopHandler(uint64_t id) {
+	this->stopHandlers.erase(id);
+}
+
+int NetworkReactor::nextTimeout() {
+	if (this->timers.empty()) {
+		return -1; // sleep until something happens
+	}
+	unsigned long long now = GetTickCount64();
+	unsigned long long deadline = this->timers.begin()->first.first;
+	if (deadline <= now) {
+		return 0;
+	}
+	return (int)(deadline - now);
+}
+
+void NetworkReactor::runTimers() {
+	unsigned long long now = GetTickCount64();
+	while (!this->timers.empty() && this->timers.begin()->first.first <= now) {
+		uint64_t id = this->timers.begin()->first.second;
+		ReactorTask task = std::move(this->timers.begin()->second);
+		this->timers.erase(this->timers.begin());
+		this->timerDeadlines.erase(id);
+		task();
+	}
+}
+
+void NetworkReactor::runTasks() {
+	vector<ReactorTask> tasks;
+	{
+		const std::lock_guard<std::mutex> lock(this->tasksMutex);
+		tasks.swap(this->tasks);
+	}
+	for (vector<ReactorTask>::iterator it = tasks.begin(); it != tasks.end(); ++it) {
+		(*it)();
+	}
+}
+
+void NetworkReactor::loop() {
+	struct epoll_event events[REACTOR_MAX_EVENTS];
+
+	while (this->running) {
+		int count = epoll_wait(this->epollFd, events, REACTOR_MAX_EVENTS, this->nextTimeout());
+		if (count == -1 && errno != EINTR) {
+			break;
+		}
+
+		for (int n = 0; n < count; n++) {
+			uint64_t id = events[n].data.u64;
+			if (id == 0) {
+				uint64_t value;
+				ssize_t res = read(this->eventFd, &value, sizeof(uint64_t));
+				(void)res;
+				continue;
+			}
+			// the handler may have been removed by a previous handler
+			unordered_map<uint64_t, Entry>::iterator it = this->entries.find(id);
+			if (it != this->entries.end()) {
+				shared_ptr<ReactorHandler> handler = it->second.handler;
+				(*handler)(events[n].events);
+			}
+		}
+
+		this->runTimers();
+		this->runTasks();
+	}
+
+	// tasks posted before stop() still get executed, so call() never hangs
+	this->runTasks();
+
+	// operations still pending fail now instead of leaving their callers waiting
+	map<uint64_t, ReactorTask> stopHandlers;
+	stopHandlers.swap(this->stopHandlers);
+	for (map<uint64_t, ReactorTask>::iterator it = stopHandlers.begin(); it != stopHandlers.end(); ++it) {
+		it->second();
+	}
+}
+
+struct WritableWait {
+	uint64_t ioId;
+	uint64_t timerId;
+	uint64_t stopId;
+	promise<bool> result;
+};
+
+static void endWritableWait(NetworkReactor *reactor, shared_ptr<WritableWait> wait, bool connected) {
+	reactor->remove(wait->ioId);
+	reactor->cancelTimer(wait->timerId);
+	reactor->removeStopHandler(wait->stopId);
+	wait->result.set_value(connected);
+}
+
+bool NetworkReactor::waitWritable(int fd, unsigned int timeout) {
+	shared_ptr<WritableWait> wait = make_shared<WritableWait>();
+	wait->ioId = 0;
+	wait->timerId = 0;
+	wait->stopId = 0;
+	future<bool> f = wait->result.get_future();
+
+	if (!this->post([this, fd, timeout, wait] {
+		wait->ioId = this->add(fd, EPOLLOUT, [this, fd, wait](uint32_t events) {
+			endWritableWait(this, wait, isConnected(fd, events));
+		});
+		if (!wait->ioId) {
+			wait->result.set_value(false);
+			return;
+		}
+		wait->timerId = this->addTimer(timeout, [this, wait] {
+			endWritableWait(this, wait, false);
+		});
+		wait->stopId = this->addStopHandler([this, wait] {
+			endWritableWait(this, wait, false);
+		});
+	})) {
+		return false;
+	}
+
+	try {
+		return f.get();
+	}
+	catch (const future_error&) { // not expected, the stop handler answers
+		return false;
+	}
+}
+
+bool NetworkReactor::isConnected(int fd, uint32_t events) {
+	if (!(events & EPOLLOUT) || (events & (EPOLLERR | EPOLLHUP))) {
+		return false;
+	}
+	int error = 0;
+	socklen_t len = sizeof(int);
+	if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) != 0) {
+		return false;
+	}
+	return error == 0;
+}
@@ -0,0 +1,111 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _REACTOR_
+#define _REACTOR_
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include "translator.h"
+
+using namespace std;
+
+#define REACTOR_MAX_EVENTS	64
+#define REACTOR_NOTIFY		0x08000000 // passed to a handler by notify(), not used by epoll
+
+typedef function<void(uint32_t events)> ReactorHandler;
+typedef function<void()> ReactorTask;
+
+// One event loop thread for all sockets of the app (epoll, eventfd for wake ups).
+// Sockets, handlers and timers are only touched on the loop thread; other threads
+// hand over work with post() or call(). Without timers the loop sleeps until a
+// socket or another thread wakes it up.
+class NetworkReactor
+{
+private:
+	struct Entry {
+		int fd;
+		shared_ptr<ReactorHandler> handler;
+	};
+	int epollFd;
+	int eventFd;
+	thread loopThreadHandle;
+	thread::id loopThreadId;
+	atomic<bool> running;
+	mutex tasksMutex;
+	vector<ReactorTask> tasks;
+	// loop thread only
+	uint64_t nextId;
+	unordered_map<uint64_t, Entry> entries;
+	map<pair<unsigned long long, uint64_t>, ReactorTask> timers; // (deadline, id) -> task
+	unordered_map<uint64_t, unsigned long long> timerDeadlines;
+	map<uint64_t, ReactorTask> stopHandlers;
+
+	static NetworkReactor *instance;
+
+	void loop();
+	void runTasks();
+	void runTimers();
+	int nextTimeout();
+	void wakeUp();
+	void shutdown();
+public:
+	NetworkReactor(); // throws exception
+	~NetworkReactor();
+
+	static bool start();
+	static void stop();
+	static void cancel(); // ends the loop but keeps the instance, so other threads fail instead of crashing
+	static NetworkReactor *get();
+
+	bool isLoopThread();
+	bool post(ReactorTask task);
+	bool call(ReactorTask task); // waits until the task has been executed
+	bool notify(uint64_t id);
+
+	// loop thread only
+	uint64_t add(int fd, uint32_t events, ReactorHandler handler);
+	bool modify(uint64_t id, uint32_t events);
+	void remove(uint64_t id);
+	uint64_t addTimer(unsigned int ms, ReactorTask task);
+	void cancelTimer(uint64_t id);
+	// runs if the reactor stops before removeStopHandler(), fails an operation another thread waits for
+	uint64_t addStopHandler(ReactorTask task);
+	void removeStopHandler(uint64_t id);
+
+	// any thread but the loop thread
+	bool waitWritable(int fd, unsigned int timeout);
+
+	static bool isConnected(int fd, uint32_t events);
+};
+
+#endif
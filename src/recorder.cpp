@@ -0,0 +1,169 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "recorder.h"
+#include <string.h>
+#include <thread>
+#include "netmessage.h"
+#ifdef __linux__
+	#include "translator.h"
+#endif
+
+static void putLE(unsigned char *buffer, uint64_t value, int bytes) {
+	for (int n = 0; n < bytes; n++) {
+		buffer[n] = (unsigned char)(value >> (8 * n));
+	}
+}
+
+static uint64_t getLE(const unsigned char *buffer, int bytes) {
+	uint64_t value = 0;
+	for (int n = 0; n < bytes; n++) {
+		value |= (uint64_t)buffer[n] << (8 * n);
+	}
+	return value;
+}
+
+TrafficRecorder::TrafficRecorder() {
+	this->file = NULL;
+	this->frames = 0;
+}
+
+TrafficRecorder::~TrafficRecorder() {
+	this->close();
+}
+
+bool TrafficRecorder::open(const string &path) {
+	const std::lock_guard<std::mutex> lock(this->fileMutex);
+	if (this->file) {
+		fclose(this->file);
+		this->file = NULL;
+	}
+	if (fopen_s(&this->file, path.c_str(), "wb") != 0 || !this->file) {
+		this->file = NULL;
+		return false;
+	}
+	fwrite(RECORD_FILE_MAGIC, 1, 8, this->file);
+	this->start = chrono::steady_clock::now();
+	this->frames = 0;
+	return true;
+}
+
+void TrafficRecorder::close() {
+	const std::lock_guard<std::mutex> lock(this->fileMutex);
+	if (this->file) {
+		fclose(this->file);
+		this->file = NULL;
+	}
+}
+
+bool TrafficRecorder::isOpen() {
+	const std::lock_guard<std::mutex> lock(this->fileMutex);
+	return this->file != NULL;
+}
+
+void TrafficRecorder::record(int direction, string_view data) {
+	uint64_t time = (uint64_t)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - this->start).count();
+
+	unsigned char header[13];
+	putLE(header, time, 8);
+	header[8] = (unsigned char)direction;
+	putLE(header + 9, (uint64_t)data.length(), 4);
+
+	const std::lock_guard<std::mutex> lock(this->fileMutex);
+	if (!this->file) {
+		return;
+	}
+	fwrite(header, 1, sizeof(header), this->file);
+	fwrite(data.data(), 1, data.length(), this->file);
+	this->frames++;
+}
+
+uint64_t TrafficRecorder::getFrames() {
+	const std::lock_guard<std::mutex> lock(this->fileMutex);
+	return this->frames;
+}
+
+bool loadRecording(const string &path, vector<RecordedFrame> &frames) {
+	FILE *file = NULL;
+	if (fopen_s(&file, path.c_str(), "rb") != 0 || !file) {
+		return false;
+	}
+
+	char magic[8];
+	if (fread(magic, 1, 8, file) != 8 || memcmp(magic, RECORD_FILE_MAGIC, 8) != 0) {
+		fclose(file);
+		return false;
+	}
+
+	unsigned char header[13];
+	while (fread(header, 1, sizeof(header), file) == sizeof(header)) {
+		RecordedFrame frame;
+		frame.time = getLE(header, 8);
+		frame.direction = header[8];
+		size_t length = (size_t)getLE(header + 9, 4);
+		frame.length = length;
+		frame.data.resize(length + FRAME_BUFFER_PADDING);
+		if (length && fread(&frame.data[0], 1, length, file) != length) {
+			break; // cut off while recording
+		}
+		frames.push_back(frame);
+	}
+	fclose(file);
+	return true;
+}
+
+bool replayRecording(const string &path, double speed, void (*MessageCallback)(int, string_view), const atomic<bool> &stop, ReplayStats &stats) {
+	memset(&stats, 0, sizeof(ReplayStats));
+
+	vector<RecordedFrame> frames;
+	if (!loadRecording(path, frames)) {
+		return false;
+	}
+	if (!frames.empty()) {
+		stats.recordedSeconds = (double)frames.back().time / 1000000.0;
+	}
+
+	MessageCallback(MSG_CLIENT_CONNECTED, string_view());
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	for (vector<RecordedFrame>::iterator it = frames.begin(); it != frames.end() && !stop; ++it) {
+		if (it->direction != RECORD_RECEIVED) {
+			stats.skipped++;
+			continue;
+		}
+		if (speed > 0.0) {
+			chrono::steady_clock::time_point due = start + chrono::microseconds((long long)((double)it->time / speed));
+			// a long pause of the recording does not hold up the stop
+			while (!stop && due > chrono::steady_clock::now()) {
+				this_thread::sleep_until(min(due, chrono::steady_clock::now() + chrono::milliseconds(REPLAY_STOP_CHECK)));
+			}
+			if (stop) {
+				break;
+			}
+		}
+		MessageCallback(MSG_TEXT, string_view(it->data.data(), it->length));
+		stats.frames++;
+		stats.bytes += it->length;
+	}
+	stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	MessageCallback(MSG_CLIENT_DISCONNECTED, string_view());
+	return true;
+}
@@ -0,0 +1,85 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _RECORDER_
+#define _RECORDER_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <atomic>
+#include "framebuffer.h"
+
+using namespace std;
+
+#define RECORD_FILE_MAGIC	"CFREC001"
+#define RECORD_RECEIVED		1 // frame from the server
+#define RECORD_SENT			2 // command to the server
+#define REPLAY_STOP_CHECK	50 // ms, longest sleep of the replay between two looks at the stop flag
+
+// File layout: the 8 byte magic, then one record per frame:
+// uint64 microseconds since the start, uint8 direction, uint32 length, the frame without NUL.
+// All numbers are little endian.
+struct RecordedFrame {
+	uint64_t time; // microseconds since the start of the recording
+	int direction;
+	size_t length;
+	string data; // length bytes followed by FRAME_BUFFER_PADDING zeros, like in the receive buffer
+};
+
+struct ReplayStats {
+	uint64_t frames; // received frames fed to the callback
+	uint64_t bytes;
+	uint64_t skipped; // sent commands, not replayed
+	double seconds; // wall time of the replay
+	double recordedSeconds; // duration of the recording
+};
+
+// Writes every frame with a timestamp, much cheaper than extended logging.
+class TrafficRecorder
+{
+private:
+	mutex fileMutex;
+	FILE *file;
+	chrono::steady_clock::time_point start;
+	uint64_t frames;
+public:
+	TrafficRecorder();
+	~TrafficRecorder();
+	bool open(const string &path);
+	void close();
+	bool isOpen();
+	void record(int direction, string_view data); // thread safe
+	uint64_t getFrames();
+};
+
+bool loadRecording(const string &path, vector<RecordedFrame> &frames);
+
+// feeds the received frames of a recording to MessageCallback as MSG_TEXT, without a socket;
+// speed 1.0 keeps the recorded timing, 2.0 plays twice as fast, 0 as fast as possible;
+// ends early once stop is set
+bool replayRecording(const string &path, double speed, void (*MessageCallback)(int, string_view), const atomic<bool> &stop, ReplayStats &stats);
+
+#endif
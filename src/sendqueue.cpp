@@ -0,0 +1,182 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "sendqueue.h"
+
+SendQueue::SendQueue(size_t capacity) : queue(capacity) {
+	this->dropped = 0;
+	this->overflowCommands = 0;
+	this->overflowing = false;
+	this->first = 0;
+	this->offset = 0;
+	this->coalesced = 0;
+}
+
+bool SendQueue::getValuePath(const string &msg, string &path) {
+	if (msg.compare(0, 4, "set ") != 0) {
+		return false;
+	}
+	size_t pos = msg.find_last_of(' ');
+	if (pos == string::npos || pos < 4) {
+		return false;
+	}
+	// set /devices/0/inputs/3/FaderLevel/value/ -12.0
+	size_t value = msg.rfind("/value", pos);
+	if (value == string::npos || (value + 6 != pos && value + 7 != pos)) {
+		return false;
+	}
+	path = msg.substr(0, pos);
+	return true;
+}
+
+bool SendQueue::push(const string &msg) {
+	if (!this->overflowing.load(memory_order_acquire)) {
+		string data = msg;
+		if (this->queue.push(std::move(data))) {
+			return true;
+		}
+	}
+
+	string path;
+	const std::lock_guard<std::mutex> lock(this->overflowMutex);
+	if (getValuePath(msg, path)) {
+		unordered_map<string, size_t>::iterator it = this->overflowValues.find(path);
+		if (it != this->overflowValues.end()) {
+			this->overflow[it->second] = msg;
+			this->coalesced++;
+			return true;
+		}
+		this->overflowValues[path] = this->overflow.size();
+	}
+	else if (this->overflowCommands >= SEND_QUEUE_SIZE) {
+		this->dropped++;
+		return false;
+	}
+	else {
+		this->overflowCommands++;
+	}
+	this->overflow.push_back(msg);
+	this->overflowing.store(true, memory_order_release);
+	return true;
+}
+
+void SendQueue::addPending(string &msg) {
+	string path;
+	if (getValuePath(msg, path)) {
+		unordered_map<string, size_t>::iterator it = this->pendingValues.find(path);
+		if (it != this->pendingValues.end() && it->second >= this->first
+			&& !(it->second == this->first && this->offset > 0)) {
+			this->pending[it->second].swap(msg);
+			this->coalesced++;
+			return;
+		}
+		this->pendingValues[path] = this->pending.size();
+	}
+	this->pending.push_back(std::move(msg));
+}
+
+size_t SendQueue::collect() {
+	// a connection that never gets empty does not keep the sent messages forever
+	if (this->first >= SEND_PENDING_SIZE) {
+		this->pending.erase(this->pending.begin(), this->pending.begin() + this->first);
+		for (unordered_map<string, size_t>::iterator it = this->pendingValues.begin(); it != this->pendingValues.end();) {
+			if (it->second < this->first) {
+				it = this->pendingValues.erase(it);
+			}
+			else {
+				it->second -= this->first;
+				++it;
+			}
+		}
+		this->first = 0;
+	}
+
+	size_t count = 0;
+	string msg;
+	while (this->pending.size() - this->first < SEND_PENDING_SIZE && this->queue.pop(msg)) {
+		count++;
+		this->addPending(msg);
+	}
+
+	// the overflow is newer than everything in the queue; once it is in use, a producer does not
+	// put anything into the queue, so what is left there is taken first
+	if (this->pending.size() - this->first < SEND_PENDING_SIZE && this->overflowing.load(memory_order_acquire)) {
+		while (this->queue.pop(msg)) { // at most its capacity
+			count++;
+			this->addPending(msg);
+		}
+
+		this->overflowMutex.lock();
+		this->collected.swap(this->overflow);
+		this->overflowValues.clear();
+		this->overflowCommands = 0;
+		this->overflowing.store(false, memory_order_release);
+		this->overflowMutex.unlock();
+
+		for (vector<string>::iterator it = this->collected.begin(); it != this->collected.end(); ++it) {
+			count++;
+			this->addPending(*it);
+		}
+		this->collected.clear();
+	}
+	return count;
+}
+
+bool SendQueue::isPending() {
+	return this->first < this->pending.size();
+}
+
+const vector<string> &SendQueue::getPending(size_t &first, size_t &offset) {
+	first = this->first;
+	offset = this->offset;
+	return this->pending;
+}
+
+size_t SendQueue::consume(size_t bytes) { // returns the number of messages sent completely
+	size_t count = 0;
+	while (bytes > 0 && this->first < this->pending.size()) {
+		size_t remaining = this->pending[this->first].length() + 1 - this->offset; // including NUL
+		if (bytes >= remaining) {
+			bytes -= remaining;
+			this->first++;
+			this->offset = 0;
+			count++;
+		}
+		else {
+			this->offset += bytes;
+			bytes = 0;
+		}
+	}
+	if (this->first >= this->pending.size()) {
+		this->pending.clear();
+		this->pendingValues.clear();
+		this->first = 0;
+		this->offset = 0;
+	}
+	return count;
+}
+
+size_t SendQueue::getCoalesced() {
+	return this->coalesced;
+}
+
+size_t SendQueue::getDropped() {
+	return this->dropped;
+}
@@ -0,0 +1,86 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SENDQUEUE_
+#define _SENDQUEUE_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+#include "mpscqueue.h"
+
+using namespace std;
+
+#define SEND_QUEUE_SIZE		4096
+#define SEND_PENDING_SIZE	4096	// messages collected by the sender thread and not sent yet, more wait in the queue
+
+struct TCPSendStats {
+	size_t messages;	// messages written to the socket
+	size_t bytes;
+	size_t syscalls;
+	size_t flushes;		// rounds of the sender thread that wrote something
+	size_t coalesced;	// values replaced by a newer value for the same path before being sent
+	size_t dropped;		// commands (not values) dropped because queue and overflow were full
+};
+
+// Output queue between the threads calling TCPClient::send() and the sender thread.
+// The messages are collected by the sender thread into a pending list of at most
+// SEND_PENDING_SIZE messages. A "set <path> <value>" replaces a pending value of the
+// same path which has not been started to send yet, so a stalled connection only keeps
+// the newest value per path.
+// Overflow policy: if the lock-free queue is full, push() puts the message into an
+// overflow list under a lock, where a value replaces the overflowed value of its path.
+// Newer messages follow into the overflow until the sender thread took it, so the order
+// is kept. Values are never lost; other commands are dropped if SEND_QUEUE_SIZE of them
+// are waiting in the overflow.
+class SendQueue
+{
+private:
+	MPSCQueue<string> queue;
+	mutex overflowMutex;
+	vector<string> overflow;
+	unordered_map<string, size_t> overflowValues; // path -> index in overflow
+	size_t overflowCommands;
+	atomic<bool> overflowing;
+	atomic<size_t> dropped;
+	atomic<size_t> coalesced;
+	// sender thread only
+	vector<string> pending;
+	unordered_map<string, size_t> pendingValues; // path -> index in pending
+	size_t first;	// first message in pending not sent completely
+	size_t offset;	// bytes of pending[first] already sent
+	vector<string> collected;
+	static bool getValuePath(const string &msg, string &path);
+	void addPending(string &msg);
+public:
+	SendQueue(size_t capacity = SEND_QUEUE_SIZE);
+	bool push(const string &msg);
+	size_t collect();
+	bool isPending();
+	const vector<string> &getPending(size_t &first, size_t &offset);
+	size_t consume(size_t bytes);
+	size_t getCoalesced();
+	size_t getDropped();
+};
+
+#endif
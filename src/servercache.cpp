@@ -0,0 +1,146 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+#include "servercache.h"
+#include "simdjson.h"
+#ifdef __linux__
+	#include "translator.h"
+#endif
+
+using namespace simdjson;
+
+bool ServerCache::load(const string &path) {
+	vector<CachedServer> loaded;
+
+	try {
+		dom::parser parser;
+		dom::element element = parser.load(path);
+
+		dom::array arr = element["servers"];
+		for (dom::element server : arr) {
+			CachedServer cached;
+			try {
+				string_view sv = server["address"];
+				cached.address = string{ sv };
+				sv = server["name"];
+				cached.name = string{ sv };
+				int64_t last_seen = server["last_seen"];
+				cached.last_seen = (long long)last_seen;
+				int64_t rtt = server["rtt_us"];
+				cached.rtt = (unsigned int)rtt;
+			}
+			catch (const simdjson_error&) {
+				continue;
+			}
+			loaded.push_back(cached);
+		}
+	}
+	catch (const simdjson_error&) {
+		return false;
+	}
+
+	const std::lock_guard<std::mutex> lock(this->cacheMutex);
+	this->servers = loaded;
+	if (this->servers.size() > SERVER_CACHE_SIZE) {
+		this->servers.resize(SERVER_CACHE_SIZE);
+	}
+
+	return true;
+}
+
+bool ServerCache::save(const string &path) {
+	FILE* fh = NULL;
+	if (fopen_s(&fh, path.c_str(), "w") == 0) {
+		fputs(this->toJSON().c_str(), fh);
+		fclose(fh);
+	}
+	else {
+		return false;
+	}
+
+	return true;
+}
+
+string ServerCache::toJSON() {
+	const std::lock_guard<std::mutex> lock(this->cacheMutex);
+
+	string json = "{\n\"servers\": [\n";
+	for (size_t n = 0; n < this->servers.size(); n++) {
+		json += "{\"address\": \"" + this->servers[n].address + "\", ";
+		json += "\"name\": \"" + this->servers[n].name + "\", ";
+		json += "\"last_seen\": " + to_string(this->servers[n].last_seen) + ", ";
+		json += "\"rtt_us\": " + to_string(this->servers[n].rtt) + "}";
+		if (n < this->servers.size() - 1) {
+			json += ",";
+		}
+		json += "\n";
+	}
+	json += "]\n}";
+
+	return json;
+}
+
+vector<CachedServer> ServerCache::get() {
+	const std::lock_guard<std::mutex> lock(this->cacheMutex);
+	return this->servers;
+}
+
+string ServerCache::getName(const string &address) {
+	const std::lock_guard<std::mutex> lock(this->cacheMutex);
+	for (vector<CachedServer>::iterator it = this->servers.begin(); it != this->servers.end(); ++it) {
+		if (it->address == address) {
+			return it->name;
+		}
+	}
+	return "";
+}
+
+void ServerCache::seen(const string &server, unsigned int rtt) {
+	const std::lock_guard<std::mutex> lock(this->cacheMutex);
+
+	CachedServer cached;
+	cached.address = server;
+	cached.name = "";
+
+	for (vector<CachedServer>::iterator it = this->servers.begin(); it != this->servers.end(); ++it) {
+		if (it->address == server || it->name == server) {
+			cached = *it;
+			this->servers.erase(it);
+			break;
+		}
+	}
+	cached.last_seen = (long long)time(NULL);
+	cached.rtt = rtt;
+
+	this->servers.insert(this->servers.begin(), cached);
+	if (this->servers.size() > SERVER_CACHE_SIZE) {
+		this->servers.resize(SERVER_CACHE_SIZE);
+	}
+}
+
+void ServerCache::setName(const string &address, const string &name) {
+	const std::lock_guard<std::mutex> lock(this->cacheMutex);
+	for (vector<CachedServer>::iterator it = this->servers.begin(); it != this->servers.end(); ++it) {
+		if (it->address == address) {
+			it->name = name;
+			break;
+		}
+	}
+}
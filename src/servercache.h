@@ -0,0 +1,59 @@
+/*
+This file is part of Cuefinger 1
+
+Cuefinger 1 gives you the possibility to remote control Universal Audio's
+Console Application via Network (TCP).
+Copyright � 2024 Frank Brempel
+
+Cuefinger 1 is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#ifndef _SERVERCACHE_
+#define _SERVERCACHE_
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <time.h>
+
+using namespace std;
+
+#define SERVER_CACHE_FILE	"servers.json"
+#define SERVER_CACHE_SIZE	16
+
+struct CachedServer {
+	string address;
+	string name;
+	long long last_seen; // unix time
+	unsigned int rtt; // connect round trip time in microseconds
+};
+
+// Servers found on previous runs, stored next to settings.json, so they can
+// be probed first on the next start instead of sweeping the whole subnet.
+class ServerCache
+{
+private:
+	mutex cacheMutex;
+	vector<CachedServer> servers; // most recently seen first
+public:
+	bool load(const string &path);
+	bool save(const string &path);
+	vector<CachedServer> get();
+	string getName(const string &address);
+	void seen(const string &server, unsigned int rtt); // server is the address or the name
+	void setName(const string &address, const string &name);
+	string toJSON();
+};
+
+#endif